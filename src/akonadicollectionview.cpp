@@ -34,6 +34,7 @@
 #include "manageshowcollectionproperties.h"
 #include "views/collectionview/reparentingmodel.h"
 #include "views/collectionview/calendardelegate.h"
+#include "views/collectionview/calendardelegatemodel.h"
 #include "views/collectionview/quickview.h"
 
 #include <CalendarSupport/KCalPrefs>
@@ -184,35 +185,75 @@ private Q_SLOTS:
                 return;
             }
         }
-        for (int i = start; i <= end; ++i) {
-            const QModelIndex index = mTreeView->model()->index(i, 0, parent);
-            // qCDebug(KORGANIZER_LOG) << "expanding " << index.data().toString();
-            if (index.data(NodeTypeRole).toInt() == PersonNodeRole) {
-                mTreeView->collapse(index);
-            } else {
-                mTreeView->expand(index);
-            }
-            if (mTreeView->model()->hasChildren(index)) {
-                onSourceRowsInserted(index, 0, mTreeView->model()->rowCount(index) - 1);
-            }
-        }
+        updateExpansion(parent, start, end);
     }
 
     void onLayoutChanged()
     {
         if (mExpandAll) {
-            onSourceRowsInserted(QModelIndex(), 0, mTreeView->model()->rowCount(QModelIndex()) - 1);
+            updateExpansion(QModelIndex(), 0, mTreeView->model()->rowCount(QModelIndex()) - 1);
         }
     }
 
     void onModelReset()
     {
         if (mExpandAll) {
-            onSourceRowsInserted(QModelIndex(), 0, mTreeView->model()->rowCount(QModelIndex()) - 1);
+            updateExpansion(QModelIndex(), 0, mTreeView->model()->rowCount(QModelIndex()) - 1);
         }
     }
 
 private:
+    void collectNodes(const QModelIndex &parent, int start, int end, QModelIndexList &toExpand,
+                      QModelIndexList &persons) const
+    {
+        const QAbstractItemModel *model = mTreeView->model();
+        for (int i = start; i <= end; ++i) {
+            const QModelIndex index = model->index(i, 0, parent);
+            const bool hasChildren = model->hasChildren(index);
+            if (index.data(NodeTypeRole).toInt() == PersonNodeRole) {
+                persons << index;
+            } else if (!mTreeView->isExpanded(index)) {
+                //Leaves are expanded as well so that children added later on show up
+                toExpand << index;
+            }
+            if (hasChildren) {
+                collectNodes(index, 0, model->rowCount(index) - 1, toExpand, persons);
+            }
+        }
+    }
+
+    /**
+     * Expands the given rows and their descendants, except for person nodes which are collapsed.
+     * Indexes that are already in the right state are left alone, and the remaining ones are
+     * applied in one go, so the view doesn't lay out and repaint itself once per index.
+     */
+    void updateExpansion(const QModelIndex &parent, int start, int end)
+    {
+        QModelIndexList toExpand;
+        QModelIndexList persons;
+        collectNodes(parent, start, end, toExpand, persons);
+        QModelIndexList toCollapse;
+        for (const QModelIndex &index : qAsConst(persons)) {
+            if (mTreeView->isExpanded(index)) {
+                toCollapse << index;
+            }
+        }
+        if (toExpand.isEmpty() && toCollapse.isEmpty()) {
+            return;
+        }
+
+        const bool updatesEnabled = mTreeView->updatesEnabled();
+        mTreeView->setUpdatesEnabled(false);
+        for (const QModelIndex &index : qAsConst(toExpand)) {
+            // qCDebug(KORGANIZER_LOG) << "expanding " << index.data().toString();
+            mTreeView->expand(index);
+        }
+        for (const QModelIndex &index : qAsConst(toCollapse)) {
+            mTreeView->collapse(index);
+        }
+        mTreeView->setUpdatesEnabled(updatesEnabled);
+    }
+
     void saveTreeState()
     {
         Akonadi::ETMViewStateSaver treeStateSaver;
@@ -416,86 +457,6 @@ protected:
         return QSortFilterProxyModel::data(index, role);
     }
 };
-
-class CalendarDelegateModel : public QSortFilterProxyModel
-{
-public:
-    explicit CalendarDelegateModel(QObject *parent = nullptr)
-        : QSortFilterProxyModel(parent)
-    {
-    }
-
-protected:
-    bool checkChildren(const QModelIndex &index, int role, const QVariant &value) const
-    {
-        const QModelIndex sourceIndex = mapToSource(index);
-        for (int i = 0; i < sourceModel()->rowCount(sourceIndex); ++i) {
-            const QModelIndex child = sourceModel()->index(i, 0, sourceIndex);
-            if (child.data(role) != value) {
-                return false;
-            }
-        }
-        return true;
-    }
-
-    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
-    {
-        if (role == Qt::CheckStateRole) {
-            if (sourceModel()->hasChildren(mapToSource(index))
-                && index.data(NodeTypeRole).toInt() == PersonNodeRole) {
-                bool allChecked = checkChildren(index, role, Qt::Checked);
-                bool allUnchecked = checkChildren(index, role, Qt::Unchecked);
-                if (allChecked) {
-                    return Qt::Checked;
-                } else if (allUnchecked) {
-                    return Qt::Unchecked;
-                } else {
-                    return Qt::PartiallyChecked;
-                }
-            }
-        }
-        if (role == EnabledRole) {
-            if (sourceModel()->hasChildren(mapToSource(index))
-                && index.data(NodeTypeRole).toInt() == PersonNodeRole) {
-                bool allChecked = checkChildren(index, role, Qt::Checked);
-                bool allUnchecked = checkChildren(index, role, Qt::Unchecked);
-                // qCDebug(KORGANIZER_LOG) << "person node " << index.data().toString() << allChecked << allUnchecked;
-                if (allChecked) {
-                    return Qt::Checked;
-                } else if (allUnchecked) {
-                    return Qt::Unchecked;
-                } else {
-                    return Qt::PartiallyChecked;
-                }
-            }
-        }
-
-        return QSortFilterProxyModel::data(index, role);
-    }
-
-    void setChildren(const QModelIndex &sourceIndex, const QVariant &value, int role) const
-    {
-        if (!sourceIndex.isValid()) {
-            return;
-        }
-        for (int i = 0; i < sourceModel()->rowCount(sourceIndex); ++i) {
-            const QModelIndex child = sourceModel()->index(i, 0, sourceIndex);
-            sourceModel()->setData(child, value, role);
-            setChildren(child, value, role);
-        }
-    }
-
-    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override
-    {
-        if (role == Qt::CheckStateRole) {
-            if (sourceModel()->hasChildren(mapToSource(index))
-                && index.data(NodeTypeRole).toInt() == PersonNodeRole) {
-                setChildren(mapToSource(index), value, role);
-            }
-        }
-        return QSortFilterProxyModel::setData(index, value, role);
-    }
-};
 } // anonymous namespace
 
 CalendarViewExtension *AkonadiCollectionViewFactory::create(QWidget *parent)
@@ -521,6 +482,7 @@ AkonadiCollectionView *AkonadiCollectionViewFactory::collectionView() const
 AkonadiCollectionView::AkonadiCollectionView(CalendarView *view, bool hasContextMenu,
                                              QWidget *parent)
     : CalendarViewExtension(parent)
+    , mCalendarView(view)
     , mActionManager(nullptr)
     , mCollectionView(nullptr)
     , mBaseModel(nullptr)
@@ -1137,15 +1099,19 @@ void AkonadiCollectionView::onAction(const QModelIndex &index, int a)
             }
             person = i.data(PersonRole);
         }
+        //Collections the main calendar has loaded are shown from there
+        const Akonadi::ETMCalendar::Ptr calendar
+            = mCalendarView ? mCalendarView->calendar() : Akonadi::ETMCalendar::Ptr();
         if (person.isValid()) {
             Quickview *quickview = new Quickview(
-                person.value<KPIM::Person>(), CalendarSupport::collectionFromIndex(index));
+                person.value<KPIM::Person>(), CalendarSupport::collectionFromIndex(index),
+                calendar);
             quickview->setAttribute(Qt::WA_DeleteOnClose, true);
             quickview->show();
         } else {
             qCWarning(KORGANIZER_LOG) << "No valid person found for" << index;
             Quickview *quickview = new Quickview(
-                KPIM::Person(), CalendarSupport::collectionFromIndex(index));
+                KPIM::Person(), CalendarSupport::collectionFromIndex(index), calendar);
             quickview->setAttribute(Qt::WA_DeleteOnClose, true);
             quickview->show();
         }
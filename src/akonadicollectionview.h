@@ -112,6 +112,7 @@ private Q_SLOTS:
 private:
     Akonadi::EntityTreeModel *entityTreeModel() const;
 
+    CalendarView *mCalendarView = nullptr;
     Akonadi::StandardCalendarActionManager *mActionManager = nullptr;
     Akonadi::EntityTreeView *mCollectionView = nullptr;
     QStackedWidget *mStackedWidget = nullptr;
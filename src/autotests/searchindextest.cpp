@@ -0,0 +1,139 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include "searchindextest.h"
+
+#include "../dialog/searchindex.h"
+
+#include <KCalCore/Event>
+#include <KCalCore/MemoryCalendar>
+
+#include <QTest>
+
+QTEST_MAIN(SearchIndexTest)
+
+static KCalCore::Event::Ptr createEvent(const QString &uid, const QString &summary)
+{
+    KCalCore::Event::Ptr event(new KCalCore::Event);
+    event->setUid(uid);
+    event->setSummary(summary);
+    event->setDtStart(QDateTime(QDate(2017, 5, 1), QTime(10, 0)));
+    event->setDtEnd(QDateTime(QDate(2017, 5, 1), QTime(11, 0)));
+    return event;
+}
+
+static QSet<QString> candidates(const SearchIndex &index, const QString &pattern,
+                                SearchIndex::Fields fields)
+{
+    QSet<QString> result;
+    if (!index.candidates(pattern, fields, result)) {
+        return QSet<QString>() << QStringLiteral("all");
+    }
+    return result;
+}
+
+void SearchIndexTest::shouldSplitWords()
+{
+    QCOMPARE(SearchIndex::words(QStringLiteral("Team Meeting, room 4.2")),
+             QStringList() << QStringLiteral("team") << QStringLiteral("meeting")
+                           << QStringLiteral("room") << QStringLiteral("4") << QStringLiteral("2"));
+    QCOMPARE(SearchIndex::words(QStringLiteral(" -- ")), QStringList());
+}
+
+void SearchIndexTest::shouldFindWordsInFields()
+{
+    KCalCore::MemoryCalendar::Ptr calendar(new KCalCore::MemoryCalendar(QTimeZone::utc()));
+    KCalCore::Event::Ptr meeting = createEvent(QStringLiteral("meeting"), QStringLiteral("Team Meeting"));
+    meeting->setLocation(QStringLiteral("Berlin"));
+    meeting->addAttendee(KCalCore::Attendee::Ptr(
+                             new KCalCore::Attendee(QStringLiteral("John Doe"),
+                                                    QStringLiteral("john@example.org"))));
+    calendar->addEvent(meeting);
+    calendar->addEvent(createEvent(QStringLiteral("lunch"), QStringLiteral("Lunch in Berlin")));
+
+    const SearchIndex index(calendar);
+    const SearchIndex::Fields all = SearchIndex::Summary | SearchIndex::Description
+                                    | SearchIndex::Categories | SearchIndex::Location
+                                    | SearchIndex::Attendees;
+
+    QCOMPARE(candidates(index, QStringLiteral("meet"), all),
+             QSet<QString>() << QStringLiteral("meeting"));
+    QCOMPARE(candidates(index, QStringLiteral("EETIN"), all),
+             QSet<QString>() << QStringLiteral("meeting"));
+    QCOMPARE(candidates(index, QStringLiteral("berlin"), all),
+             QSet<QString>() << QStringLiteral("meeting") << QStringLiteral("lunch"));
+    QCOMPARE(candidates(index, QStringLiteral("berlin"), SearchIndex::Location),
+             QSet<QString>() << QStringLiteral("meeting"));
+    QCOMPARE(candidates(index, QStringLiteral("john@example"), SearchIndex::Attendees),
+             QSet<QString>() << QStringLiteral("meeting"));
+    QCOMPARE(candidates(index, QStringLiteral("john"), SearchIndex::Summary), QSet<QString>());
+    QCOMPARE(candidates(index, QStringLiteral("dinner"), all), QSet<QString>());
+}
+
+void SearchIndexTest::shouldIgnoreWildcards()
+{
+    KCalCore::MemoryCalendar::Ptr calendar(new KCalCore::MemoryCalendar(QTimeZone::utc()));
+    calendar->addEvent(createEvent(QStringLiteral("meeting"), QStringLiteral("Team Meeting")));
+    const SearchIndex index(calendar);
+
+    QCOMPARE(candidates(index, QStringLiteral("t*meeting"), SearchIndex::Summary),
+             QSet<QString>() << QStringLiteral("meeting"));
+    QCOMPARE(candidates(index, QStringLiteral("[xyz]eeting"), SearchIndex::Summary),
+             QSet<QString>() << QStringLiteral("meeting"));
+    QCOMPARE(candidates(index, QStringLiteral("*?"), SearchIndex::Summary),
+             QSet<QString>() << QStringLiteral("all"));
+}
+
+void SearchIndexTest::shouldFollowCalendarChanges()
+{
+    KCalCore::MemoryCalendar::Ptr calendar(new KCalCore::MemoryCalendar(QTimeZone::utc()));
+    const SearchIndex index(calendar);
+    const KCalCore::Event::Ptr event = createEvent(QStringLiteral("event"), QStringLiteral("Review"));
+    calendar->addEvent(event);
+    QCOMPARE(candidates(index, QStringLiteral("review"), SearchIndex::Summary),
+             QSet<QString>() << QStringLiteral("event"));
+
+    event->setSummary(QStringLiteral("Retrospective"));
+    QCOMPARE(candidates(index, QStringLiteral("review"), SearchIndex::Summary), QSet<QString>());
+    QCOMPARE(candidates(index, QStringLiteral("retro"), SearchIndex::Summary),
+             QSet<QString>() << QStringLiteral("event"));
+
+    calendar->deleteEvent(event);
+    QCOMPARE(candidates(index, QStringLiteral("retro"), SearchIndex::Summary), QSet<QString>());
+}
+
+void SearchIndexTest::shouldCopyCheckedFields()
+{
+    KCalCore::Event::Ptr event = createEvent(QStringLiteral("event"), QStringLiteral("Review"));
+    event->setLocation(QStringLiteral("Berlin"));
+    event->addAttendee(KCalCore::Attendee::Ptr(
+                           new KCalCore::Attendee(QStringLiteral("John Doe"),
+                                                  QStringLiteral("john@example.org"))));
+
+    //Folding is left to the worker threads
+    const SearchIndex::Text all = SearchIndex::text(event, SearchIndex::Summary | SearchIndex::Location
+                                                    | SearchIndex::Attendees);
+    QCOMPARE(all.summary, QStringLiteral("Review"));
+    QCOMPARE(all.location, QStringLiteral("Berlin"));
+    QCOMPARE(all.attendees, QStringList() << QStringLiteral("John Doe <john@example.org>"));
+
+    const SearchIndex::Text summary = SearchIndex::text(event, SearchIndex::Summary);
+    QCOMPARE(summary.summary, QStringLiteral("Review"));
+    QVERIFY(summary.location.isEmpty());
+    QVERIFY(summary.attendees.isEmpty());
+}
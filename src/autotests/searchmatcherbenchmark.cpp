@@ -0,0 +1,106 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include "../dialog/searchmatcher.h"
+
+#include <QObject>
+#include <QTest>
+
+/**
+ * Compares the compiled search patterns with the wildcard QRegExp the search dialog used before.
+ *
+ * Not part of the tests run by ctest. Run it by hand after changing SearchMatcher, the
+ * literal kind is meant to be at least ten times faster than the QRegExp.
+ */
+class SearchMatcherBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    QStringList texts() const
+    {
+        QStringList result;
+        result.reserve(10000);
+        for (int i = 0; i < 10000; ++i) {
+            result.append(QStringLiteral("Weekly planning meeting %1 with the team about project %2, "
+                                         "in room %3 of the main building").arg(i).arg(i % 97).arg(i % 13));
+        }
+        return result;
+    }
+
+    void patterns_data()
+    {
+        QTest::addColumn<QString>("pattern");
+        QTest::newRow("literal") << QStringLiteral("John Doe");
+        QTest::newRow("glob") << QStringLiteral("John*Doe");
+        QTest::newRow("regexp") << QStringLiteral("[J]ohn Doe");
+    }
+
+private Q_SLOTS:
+    void regExp_data()
+    {
+        patterns_data();
+    }
+
+    void regExp()
+    {
+        QFETCH(QString, pattern);
+        const QStringList textList = texts();
+        QRegExp re;
+        re.setPatternSyntax(QRegExp::Wildcard);
+        re.setCaseSensitivity(Qt::CaseInsensitive);
+        re.setPattern(pattern);
+        int count = 0;
+        QBENCHMARK {
+            for (const QString &text : textList) {
+                if (re.indexIn(text) != -1) {
+                    ++count;
+                }
+            }
+        }
+        QCOMPARE(count, 0);
+    }
+
+    void matcher_data()
+    {
+        patterns_data();
+    }
+
+    void matcher()
+    {
+        QFETCH(QString, pattern);
+        QStringList textList = texts();
+        for (QString &text : textList) {
+            text = SearchMatcher::fold(text);
+        }
+        const SearchMatcher matcher(pattern);
+        int count = 0;
+        QBENCHMARK {
+            for (const QString &text : qAsConst(textList)) {
+                if (matcher.matches(text)) {
+                    ++count;
+                }
+            }
+        }
+        QCOMPARE(count, 0);
+    }
+};
+
+QTEST_MAIN(SearchMatcherBenchmark)
+
+#include "searchmatcherbenchmark.moc"
@@ -0,0 +1,94 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include "searchmatchertest.h"
+
+#include "../dialog/searchmatcher.h"
+
+#include <QTest>
+
+QTEST_MAIN(SearchMatcherTest)
+
+Q_DECLARE_METATYPE(SearchMatcher::Kind)
+
+void SearchMatcherTest::shouldChooseKind_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<SearchMatcher::Kind>("kind");
+
+    QTest::newRow("empty") << QString() << SearchMatcher::Literal;
+    QTest::newRow("text") << QStringLiteral("Meeting") << SearchMatcher::Literal;
+    QTest::newRow("surrounding stars") << QStringLiteral("*meeting*") << SearchMatcher::Literal;
+    QTest::newRow("inner star") << QStringLiteral("team*meeting") << SearchMatcher::Glob;
+    QTest::newRow("question mark") << QStringLiteral("m??ting") << SearchMatcher::Glob;
+    QTest::newRow("character set") << QStringLiteral("[mg]eeting") << SearchMatcher::RegExp;
+}
+
+void SearchMatcherTest::shouldChooseKind()
+{
+    QFETCH(QString, pattern);
+    QFETCH(SearchMatcher::Kind, kind);
+
+    const SearchMatcher matcher(pattern);
+    QCOMPARE(matcher.kind(), kind);
+    QVERIFY(matcher.isValid());
+}
+
+void SearchMatcherTest::shouldMatchLikeWildcardRegExp_data()
+{
+    QTest::addColumn<QString>("pattern");
+
+    QTest::newRow("empty") << QString();
+    QTest::newRow("text") << QStringLiteral("meet");
+    QTest::newRow("upper case") << QStringLiteral("MEET");
+    QTest::newRow("stars only") << QStringLiteral("**");
+    QTest::newRow("leading star") << QStringLiteral("*ing");
+    QTest::newRow("trailing star") << QStringLiteral("team*");
+    QTest::newRow("inner star") << QStringLiteral("team*room");
+    QTest::newRow("repeated part") << QStringLiteral("e*e*e");
+    QTest::newRow("question mark") << QStringLiteral("m??t");
+    QTest::newRow("only question marks") << QStringLiteral("???");
+    QTest::newRow("star and question mark") << QStringLiteral("t?am*r?om");
+    QTest::newRow("character set") << QStringLiteral("[mr]oo");
+    QTest::newRow("no match") << QStringLiteral("dinner");
+    QTest::newRow("special characters") << QStringLiteral("4.2 (");
+}
+
+void SearchMatcherTest::shouldMatchLikeWildcardRegExp()
+{
+    QFETCH(QString, pattern);
+
+    const QStringList texts = {
+        QString(),
+        QStringLiteral("m"),
+        QStringLiteral("Team Meeting"),
+        QStringLiteral("team meeting in room 4.2 (second floor)"),
+        QStringLiteral("MEETROOM"),
+        QStringLiteral("Eve"),
+        QStringLiteral("Steam boat")
+    };
+
+    QRegExp re;
+    re.setPatternSyntax(QRegExp::Wildcard);
+    re.setCaseSensitivity(Qt::CaseInsensitive);
+    re.setPattern(pattern);
+    const SearchMatcher matcher(pattern);
+    for (const QString &text : texts) {
+        QCOMPARE(matcher.matches(SearchMatcher::fold(text)), re.indexIn(text) != -1);
+    }
+}
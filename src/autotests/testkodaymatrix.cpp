@@ -21,6 +21,7 @@
 #include "testkodaymatrix.h"
 
 #include "../kodaymatrix.h"
+#include "../dayinfocache.h"
 
 #include <qtest.h>
 #include <QLocale>
@@ -62,3 +63,61 @@ void KODayMatrixTest::testMatrixLimits()
         QVERIFY(range == iterator2.value());
     }
 }
+
+void KODayMatrixTest::testDayInfoCacheHits()
+{
+    DayInfoCache cache([]() {
+        return quint64(0);
+    });
+    const QDate start(2011, 1, 1);
+    const QDate end(2011, 2, 11);
+    QVERIFY(!cache.contains(start, end, DayInfoCache::Events));
+
+    cache.dayInfo(start, end, DayInfoCache::Events);
+    QVERIFY(cache.contains(start, end, DayInfoCache::Events));
+    QVERIFY(!cache.contains(start, end, DayInfoCache::Events | DayInfoCache::Todos));
+    QVERIFY(!cache.contains(start, end.addDays(1), DayInfoCache::Events));
+
+    // Prefetching uses the highlights asked for last
+    cache.prefetch(end.addDays(1), end.addDays(42));
+    QVERIFY(cache.contains(end.addDays(1), end.addDays(42), DayInfoCache::Events));
+}
+
+void KODayMatrixTest::testDayInfoCacheEviction()
+{
+    DayInfoCache cache([]() {
+        return quint64(0);
+    }, 2);
+    const QDate first(2011, 1, 1);
+    const QDate second(2011, 2, 1);
+    const QDate third(2011, 3, 1);
+
+    cache.dayInfo(first, first.addDays(41), DayInfoCache::Events);
+    cache.dayInfo(second, second.addDays(41), DayInfoCache::Events);
+    // Using the first range again makes the second one the least recently used
+    cache.dayInfo(first, first.addDays(41), DayInfoCache::Events);
+    cache.dayInfo(third, third.addDays(41), DayInfoCache::Events);
+
+    QVERIFY(cache.contains(first, first.addDays(41), DayInfoCache::Events));
+    QVERIFY(!cache.contains(second, second.addDays(41), DayInfoCache::Events));
+    QVERIFY(cache.contains(third, third.addDays(41), DayInfoCache::Events));
+}
+
+void KODayMatrixTest::testDayInfoCacheInvalidation()
+{
+    quint64 generation = 1;
+    DayInfoCache cache([&generation]() {
+        return generation;
+    });
+    const QDate start(2011, 1, 1);
+    const QDate end(2011, 2, 11);
+
+    cache.dayInfo(start, end, DayInfoCache::Events);
+    QVERIFY(cache.contains(start, end, DayInfoCache::Events));
+
+    ++generation;
+    QVERIFY(!cache.contains(start, end, DayInfoCache::Events));
+    cache.dayInfo(end.addDays(1), end.addDays(42), DayInfoCache::Events);
+    QVERIFY(cache.contains(end.addDays(1), end.addDays(42), DayInfoCache::Events));
+    QVERIFY(!cache.contains(start, end, DayInfoCache::Events));
+}
@@ -29,6 +29,9 @@ class KODayMatrixTest : public QObject
     Q_OBJECT
 private Q_SLOTS:
     void testMatrixLimits();
+    void testDayInfoCacheHits();
+    void testDayInfoCacheEviction();
+    void testDayInfoCacheInvalidation();
 };
 
 #endif
@@ -33,6 +33,7 @@
 #include "datechecker.h"
 #include "datenavigator.h"
 #include "datenavigatorcontainer.h"
+#include "dayinfocache.h"
 #include "kocorehelper.h"
 #include "kodaymatrix.h"
 #include "kodialogmanager.h"
@@ -169,6 +170,7 @@ CalendarView::CalendarView(QWidget *parent)
 
     mDateNavigatorContainer = new DateNavigatorContainer(mLeftSplitter);
     mDateNavigatorContainer->setObjectName(QStringLiteral("CalendarView::DateNavigator"));
+    mDateNavigatorContainer->setDayInfoCache(mViewManager->dayInfoCache());
 
     mTodoList = new KOTodoView(true /*sidebar*/, mLeftSplitter);
     mTodoList->setObjectName(QStringLiteral("todolist"));
@@ -269,6 +271,10 @@ CalendarView::CalendarView(QWidget *parent)
 
     connect(mDateChecker, &DateChecker::dayPassed,
             mTodoList, &BaseView::dayPassed);
+    connect(mDateChecker, &DateChecker::dayPassed,
+            this, [this]() {
+        ++mSettingsGeneration;
+    });
     connect(mDateChecker, &DateChecker::dayPassed,
             this, &CalendarView::dayPassed);
     connect(mDateChecker, &DateChecker::dayPassed,
@@ -321,6 +327,7 @@ CalendarView::CalendarView(QWidget *parent)
     Akonadi::FreeBusyManager::self()->setCalendar(mCalendar);
 
     mCalendar->registerObserver(this);
+    mViewManager->dayInfoCache()->setCalendar(mCalendar);
     mDateNavigatorContainer->setCalendar(mCalendar);
     mTodoList->setCalendar(mCalendar);
     mEventViewer->setCalendar(mCalendar.data());
@@ -601,6 +608,7 @@ void CalendarView::updateConfig(const QByteArray &receiver)
     if (receiver != "korganizer") {
         return;
     }
+    ++mSettingsGeneration;
 
     if (mCalPrinter) {
         mCalPrinter->deleteLater();
@@ -750,7 +758,7 @@ void CalendarView::changeIncidenceDisplay(const Akonadi::Item &item,
         mDateNavigatorContainer->updateView();
     }
 
-    mDialogManager->updateSearchDialog();
+    mDialogManager->updateSearchDialog(item, changeType);
 
     if (CalendarSupport::hasIncidence(item)) {
         // If there is an event view visible update the display
@@ -783,7 +791,7 @@ void CalendarView::updateView(const QDate &start, const QDate &end, const QDate
 void CalendarView::updateView()
 {
     const KCalCore::DateList tmpList = mDateNavigator->selectedDates();
-    const QDate month = mDateNavigatorContainer->monthOfNavigator();
+    const QDate month = preferredMonth();
 
     // We assume that the navigator only selects consecutive days.
     updateView(tmpList.first(), tmpList.last(), month /**preferredMonth*/);
@@ -1968,6 +1976,7 @@ void CalendarView::updateFilter()
     Q_EMIT filtersUpdated(filters, pos + 1);
 
     mCalendar->setFilter(mCurrentFilter);
+    ++mSettingsGeneration;
 }
 
 void CalendarView::filterActivated(int filterNo)
@@ -1979,12 +1988,48 @@ void CalendarView::filterActivated(int filterNo)
     if (newFilter != mCurrentFilter) {
         mCurrentFilter = newFilter;
         mCalendar->setFilter(mCurrentFilter);
+        ++mSettingsGeneration;
         mViewManager->addChange(EventViews::EventView::FilterChanged);
         updateView();
     }
     Q_EMIT filterChanged();
 }
 
+quint64 CalendarView::changeGeneration() const
+{
+    return mSettingsGeneration + mIncidenceGeneration;
+}
+
+quint64 CalendarView::settingsGeneration() const
+{
+    return mSettingsGeneration;
+}
+
+QDate CalendarView::preferredMonth() const
+{
+    return mDateNavigatorContainer->monthOfNavigator();
+}
+
+void CalendarView::calendarIncidenceAdded(const KCalCore::Incidence::Ptr &incidence)
+{
+    Q_UNUSED(incidence);
+    ++mIncidenceGeneration;
+}
+
+void CalendarView::calendarIncidenceChanged(const KCalCore::Incidence::Ptr &incidence)
+{
+    Q_UNUSED(incidence);
+    ++mIncidenceGeneration;
+}
+
+void CalendarView::calendarIncidenceDeleted(const KCalCore::Incidence::Ptr &incidence,
+                                            const KCalCore::Calendar *calendar)
+{
+    Q_UNUSED(incidence);
+    Q_UNUSED(calendar);
+    ++mIncidenceGeneration;
+}
+
 bool CalendarView::isFiltered() const
 {
     return mCurrentFilter != nullptr;
@@ -2578,6 +2623,7 @@ void CalendarView::moveIncidenceTo(const Akonadi::Item &itemmove, const QDate &d
 
 void CalendarView::resourcesChanged()
 {
+    ++mSettingsGeneration;
     mViewManager->addChange(EventViews::EventView::ResourcesChanged);
     updateView();
 }
@@ -166,6 +166,11 @@ public:
         return mDateNavigator;
     }
 
+    DateNavigatorContainer *dateNavigatorContainer() const
+    {
+        return mDateNavigatorContainer;
+    }
+
     // TODO_NG
     //IncidenceEditors::IncidenceEditor *editorDialog( const Akonadi::Item &item ) const;
     Akonadi::IncidenceChanger *incidenceChanger() const override
@@ -215,6 +220,25 @@ public:
      */
     QString currentFilterName() const;
 
+    /**
+     * Returns a number which grows whenever the calendar, the filter or the
+     * configuration changes. Views use it to tell whether they still show
+     * the current state of the calendar.
+     */
+    quint64 changeGeneration() const;
+
+    /**
+     * Like changeGeneration(), but does not grow when incidences are added,
+     * changed or deleted. For views which apply these changes themselves.
+     */
+    quint64 settingsGeneration() const;
+
+    /**
+     * Returns the month shown first by the date navigator, which views
+     * showing whole months prefer to show.
+     */
+    QDate preferredMonth() const;
+
 Q_SIGNALS:
     /** when change is made to options dialog, the topwidget will catch this
      *  and Q_EMIT this signal which notifies all widgets which have registered
@@ -672,6 +696,15 @@ protected:
 
     bool eventFilter(QObject *watched, QEvent *event) override;
 
+    /**
+     * Reimplemented from Akonadi::ETMCalendar::CalendarObserver
+     * They increment the change generation
+     */
+    void calendarIncidenceAdded(const KCalCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceChanged(const KCalCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceDeleted(const KCalCore::Incidence::Ptr &incidence,
+                                  const KCalCore::Calendar *calendar) override;
+
 private Q_SLOTS:
     void onCheckableProxyAboutToToggle(bool newState);
     void onCheckableProxyToggled(bool newState);
@@ -751,6 +784,9 @@ private:
     AkonadiCollectionView *mETMCollectionView = nullptr;
 
     SearchCollectionHelper mSearchCollectionHelper;
+
+    quint64 mSettingsGeneration = 1;
+    quint64 mIncidenceGeneration = 1;
 };
 
 #endif
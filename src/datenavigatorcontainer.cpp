@@ -27,6 +27,7 @@
 */
 
 #include "datenavigatorcontainer.h"
+#include "dayinfocache.h"
 #include "widgets/kdatenavigator.h"
 #include "kodaymatrix.h"
 #include "koglobals.h"
@@ -103,6 +104,28 @@ void DateNavigatorContainer::setCalendar(const Akonadi::ETMCalendar::Ptr &calend
     }
 }
 
+void DateNavigatorContainer::setDayInfoCache(DayInfoCache *cache)
+{
+    mDayInfoCache = cache;
+    mNavigatorView->setDayInfoCache(cache);
+    for (KDateNavigator *n : qAsConst(mExtraViews)) {
+        if (n) {
+            n->setDayInfoCache(cache);
+        }
+    }
+}
+
+void DateNavigatorContainer::prefetch(const QDate &month)
+{
+    if (!mDayInfoCache || !month.isValid()) {
+        return;
+    }
+    for (int i = 0; i <= mExtraViews.count(); ++i) {
+        const QPair<QDate, QDate> limits = KODayMatrix::matrixLimits(month.addMonths(i));
+        mDayInfoCache->prefetch(limits.first, limits.second);
+    }
+}
+
 // TODO_Recurrence: let the navigators update just once, and tell them that
 // if data has changed or just the selection (because then the list of dayss
 // with events doesn't have to be updated if the month stayed the same
@@ -245,6 +268,7 @@ void DateNavigatorContainer::resizeAllContents()
         while (count > (mExtraViews.count() + 1)) {
             KDateNavigator *n = new KDateNavigator(this);
             mExtraViews.append(n);
+            n->setDayInfoCache(mDayInfoCache);
             n->setCalendar(mCalendar);
             connectNavigatorView(n);
         }
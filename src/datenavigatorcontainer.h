@@ -33,6 +33,7 @@
 
 #include <QFrame>
 #include <QDate>
+class DayInfoCache;
 class KDateNavigator;
 
 class DateNavigatorContainer : public QFrame
@@ -47,6 +48,17 @@ public:
     */
     void setCalendar(const Akonadi::ETMCalendar::Ptr &);
 
+    /**
+      Share @p cache between the navigators, it keeps the days they computed.
+    */
+    void setDayInfoCache(DayInfoCache *cache);
+
+    /**
+      Computes the days the navigators need for showing @p month first ahead
+      of time, so that they are cached when the navigators get there.
+    */
+    void prefetch(const QDate &month);
+
     QSize minimumSizeHint() const override;
     QSize sizeHint() const override;
     void setHighlightMode(bool highlightEvents, bool highlightTodos, bool highlightJournals) const;
@@ -153,6 +165,7 @@ private:
     KDateNavigator *mNavigatorView = nullptr;
 
     Akonadi::ETMCalendar::Ptr mCalendar;
+    DayInfoCache *mDayInfoCache = nullptr;
 
     QList<KDateNavigator *> mExtraViews;
 
@@ -0,0 +1,252 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+  As a special exception, permission is given to link this program
+  with any edition of Qt, and distribute the resulting executable,
+  without including the source code for Qt in the source distribution.
+*/
+
+#include "dayinfocache.h"
+#include "koglobals.h"
+#include "prefs/koprefs.h"
+
+DayInfoCache::DayInfoCache(const std::function<quint64()> &changeGeneration, int capacity)
+    : mChangeGeneration(changeGeneration)
+    , mCapacity(capacity)
+{
+}
+
+void DayInfoCache::setCalendar(const Akonadi::ETMCalendar::Ptr &calendar)
+{
+    if (calendar != mCalendar) {
+        mCalendar = calendar;
+        mEntries.clear();
+    }
+}
+
+DayInfoCache::DayInfo DayInfoCache::dayInfo(const QDate &start, const QDate &end,
+                                            Highlights highlights)
+{
+    mLastHighlights = highlights;
+
+    const quint64 generation = mChangeGeneration();
+    if (generation != mGeneration) {
+        mGeneration = generation;
+        mEntries.clear();
+    }
+
+    for (int i = 0; i < mEntries.count(); ++i) {
+        const Entry &entry = mEntries.at(i);
+        if (entry.start == start && entry.end == end && entry.highlights == highlights) {
+            if (i > 0) {
+                mEntries.prepend(mEntries.takeAt(i));
+            }
+            return mEntries.first().info;
+        }
+    }
+
+    Entry entry;
+    entry.start = start;
+    entry.end = end;
+    entry.highlights = highlights;
+    entry.info = compute(mCalendar, start, end, highlights);
+    mEntries.prepend(entry);
+    if (mEntries.count() > mCapacity) {
+        mEntries.removeLast();
+    }
+    return entry.info;
+}
+
+void DayInfoCache::prefetch(const QDate &start, const QDate &end)
+{
+    dayInfo(start, end, mLastHighlights);
+}
+
+bool DayInfoCache::contains(const QDate &start, const QDate &end, Highlights highlights) const
+{
+    if (mChangeGeneration() != mGeneration) {
+        return false;
+    }
+    for (const Entry &entry : mEntries) {
+        if (entry.start == start && entry.end == end && entry.highlights == highlights) {
+            return true;
+        }
+    }
+    return false;
+}
+
+DayInfoCache::DayInfo DayInfoCache::compute(const Akonadi::ETMCalendar::Ptr &calendar,
+                                            const QDate &start, const QDate &end,
+                                            Highlights highlights)
+{
+    DayInfo info;
+    if (calendar) {
+        if (highlights & Events) {
+            addEvents(calendar, start, end, info.incidenceDays);
+        }
+        if (highlights & Todos) {
+            addTodos(calendar, start, end, info.incidenceDays);
+        }
+        if (highlights & Journals) {
+            addJournals(calendar, start, end, info.incidenceDays);
+        }
+    }
+    info.holidays = KOGlobals::self()->holiday(start, end);
+    info.workDays = KOGlobals::self()->workDays(start, end);
+    return info;
+}
+
+void DayInfoCache::addJournals(const Akonadi::ETMCalendar::Ptr &calendar, const QDate &start,
+                               const QDate &end, QList<QDate> &days)
+{
+    const int numDays = start.daysTo(end) + 1;
+    const KCalCore::Incidence::List incidences = calendar->incidences();
+
+    for (const KCalCore::Incidence::Ptr &inc : incidences) {
+        Q_ASSERT(inc);
+        QDate d = inc->dtStart().toLocalTime().date();
+        if (inc->type() == KCalCore::Incidence::TypeJournal
+            && d >= start
+            && d <= end
+            && !days.contains(d)) {
+            days.append(d);
+        }
+        if (days.count() == numDays) {
+            // No point in wasting cpu, all days are bold already
+            break;
+        }
+    }
+}
+
+/**
+  * Although addTodos() is simpler it has some similarities with addEvents()
+  * but don't bother refactoring them so they share code, there's a bigger fish:
+  * Try to refactor addTodos(), addEvents(), addJournals(), monthview,
+  * agenda view, timeline view, event list view and todo list view
+  * all these 9 places have incidence listing code in common, maybe it could go
+  * to kcal. Ah, and then there's kontact's summary view which still uses
+  * the old CPU consuming code.
+  */
+void DayInfoCache::addTodos(const Akonadi::ETMCalendar::Ptr &calendar, const QDate &start,
+                            const QDate &end, QList<QDate> &days)
+{
+    const int numDays = start.daysTo(end) + 1;
+    const KCalCore::Todo::List incidences = calendar->todos();
+    QDate d;
+    for (const KCalCore::Todo::Ptr &t : incidences) {
+        if (days.count() == numDays) {
+            // No point in wasting cpu, all days are bold already
+            break;
+        }
+        Q_ASSERT(t);
+        if (t->hasDueDate()) {
+            ushort recurType = t->recurrenceType();
+
+            if (t->recurs()
+                && !(recurType == KCalCore::Recurrence::rDaily && !KOPrefs::instance()->mDailyRecur)
+                && !(recurType == KCalCore::Recurrence::rWeekly
+                     && !KOPrefs::instance()->mWeeklyRecur)) {
+                // It's a recurring todo, find out in which days it occurs
+                const auto timeDateList
+                    = t->recurrence()->timesInInterval(
+                    QDateTime(start, {}, Qt::LocalTime),
+                    QDateTime(end, {}, Qt::LocalTime));
+
+                for (const QDateTime &dt : timeDateList) {
+                    d = dt.toLocalTime().date();
+                    if (!days.contains(d)) {
+                        days.append(d);
+                    }
+                }
+            } else {
+                d = t->dtDue().toLocalTime().date();
+                if (d >= start && d <= end && !days.contains(d)) {
+                    days.append(d);
+                }
+            }
+        }
+    }
+}
+
+void DayInfoCache::addEvents(const Akonadi::ETMCalendar::Ptr &calendar, const QDate &start,
+                             const QDate &end, QList<QDate> &days)
+{
+    const int numDays = start.daysTo(end) + 1;
+    if (days.count() == numDays) {
+        // No point in wasting cpu, all days are bold already
+        return;
+    }
+    const KCalCore::Event::List eventlist = calendar->events(start, end, calendar->timeZone());
+
+    for (const KCalCore::Event::Ptr &event : eventlist) {
+        if (days.count() == numDays) {
+            // No point in wasting cpu, all days are bold already
+            break;
+        }
+
+        Q_ASSERT(event);
+        const ushort recurType = event->recurrenceType();
+        const QDateTime dtStart = event->dtStart().toLocalTime();
+
+        // timed incidences occur in
+        //   [dtStart(), dtEnd()[. All-day incidences occur in [dtStart(), dtEnd()]
+        // so we subtract 1 second in the timed case
+        const int secsToAdd = event->allDay() ? 0 : -1;
+        const QDateTime dtEnd = event->dtEnd().toLocalTime().addSecs(secsToAdd);
+
+        if (!(recurType == KCalCore::Recurrence::rDaily && !KOPrefs::instance()->mDailyRecur)
+            && !(recurType == KCalCore::Recurrence::rWeekly
+                 && !KOPrefs::instance()->mWeeklyRecur)) {
+            KCalCore::SortableList<QDateTime> timeDateList;
+            const bool isRecurrent = event->recurs();
+            const int eventDuration = dtStart.daysTo(dtEnd);
+
+            if (isRecurrent) {
+                //Its a recurring event, find out in which days it occurs
+                timeDateList = event->recurrence()->timesInInterval(
+                    QDateTime(start, {}, Qt::LocalTime),
+                    QDateTime(end, {}, Qt::LocalTime));
+            } else {
+                if (dtStart.date() >= start) {
+                    timeDateList.append(dtStart);
+                } else {
+                    // The event starts in another month (not visible))
+                    timeDateList.append(QDateTime(start, {}, Qt::LocalTime));
+                }
+            }
+
+            for (auto t = timeDateList.begin(); t != timeDateList.end(); ++t) {
+                //This could be a multiday event, so iterate from dtStart() to dtEnd()
+                QDate d = t->toLocalTime().date();
+                int j = 0;
+
+                QDate occurrenceEnd;
+                if (isRecurrent) {
+                    occurrenceEnd = d.addDays(eventDuration);
+                } else {
+                    occurrenceEnd = dtEnd.date();
+                }
+
+                do {
+                    days.append(d);
+                    ++j;
+                    d = d.addDays(1);
+                } while (d <= occurrenceEnd && j < numDays);
+            }
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+  As a special exception, permission is given to link this program
+  with any edition of Qt, and distribute the resulting executable,
+  without including the source code for Qt in the source distribution.
+*/
+
+#ifndef KORG_DAYINFOCACHE_H
+#define KORG_DAYINFOCACHE_H
+
+#include <Akonadi/Calendar/ETMCalendar>
+
+#include <QDate>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * Days with incidences, holidays and work days of the ranges shown by the
+ * day matrices of the date navigator.
+ *
+ * A few ranges are kept, so that paging back and forth, or to a range
+ * prepared ahead with prefetch(), doesn't expand the recurrences again.
+ * All ranges are dropped when the change generation, as returned by the
+ * function passed to the constructor, changes.
+ */
+class DayInfoCache
+{
+public:
+    enum Highlight {
+        Events = 0x01,
+        Todos = 0x02,
+        Journals = 0x04
+    };
+    Q_DECLARE_FLAGS(Highlights, Highlight)
+
+    struct DayInfo {
+        //Days with one of the highlighted kinds of incidences, to be drawn bold
+        QList<QDate> incidenceDays;
+        QMap<QDate, QStringList> holidays;
+        QList<QDate> workDays;
+    };
+
+    explicit DayInfoCache(const std::function<quint64()> &changeGeneration, int capacity = 16);
+
+    void setCalendar(const Akonadi::ETMCalendar::Ptr &calendar);
+
+    /**
+     * Returns the days from @p start to @p end, computing them if they
+     * are not cached yet.
+     */
+    DayInfo dayInfo(const QDate &start, const QDate &end, Highlights highlights);
+
+    /**
+     * Computes the days from @p start to @p end ahead of time, highlighted
+     * like the range asked for last.
+     */
+    void prefetch(const QDate &start, const QDate &end);
+
+    /**
+     * Returns true if the days from @p start to @p end are cached and still valid.
+     */
+    bool contains(const QDate &start, const QDate &end, Highlights highlights) const;
+
+    /**
+     * Computes the days from @p start to @p end of @p calendar without any caching.
+     */
+    static DayInfo compute(const Akonadi::ETMCalendar::Ptr &calendar, const QDate &start,
+                           const QDate &end, Highlights highlights);
+
+private:
+    struct Entry {
+        QDate start;
+        QDate end;
+        Highlights highlights;
+        DayInfo info;
+    };
+
+    static void addEvents(const Akonadi::ETMCalendar::Ptr &calendar, const QDate &start,
+                          const QDate &end, QList<QDate> &days);
+    static void addTodos(const Akonadi::ETMCalendar::Ptr &calendar, const QDate &start,
+                         const QDate &end, QList<QDate> &days);
+    static void addJournals(const Akonadi::ETMCalendar::Ptr &calendar, const QDate &start,
+                            const QDate &end, QList<QDate> &days);
+
+    std::function<quint64()> mChangeGeneration;
+    Akonadi::ETMCalendar::Ptr mCalendar;
+    int mCapacity;
+    quint64 mGeneration = 0;
+    Highlights mLastHighlights;
+    //Most recently used first
+    QVector<Entry> mEntries;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(DayInfoCache::Highlights)
+
+#endif
@@ -25,6 +25,9 @@
 */
 
 #include "searchdialog.h"
+#include "searchindex.h"
+#include "searchmatcher.h"
+#include "searchresultmodel.h"
 
 #include "ui_searchdialog_base.h"
 #include "calendarview.h"
@@ -32,24 +35,134 @@
 
 #include <CalendarSupport/Utils>
 
-#include <EventViews/ListView>
 #include <PimCommon/PimUtil>
 
+#include <KDateComboBox>
 #include <KMessageBox>
 #include <KConfigGroup>
 #include <KGuiItem>
 #include <KSharedConfig>
 
 #include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QMenu>
 #include <QPushButton>
+#include <QTimer>
+#include <QTreeView>
 #include <QVBoxLayout>
+#include <QtConcurrentMap>
 
 using namespace KOrg;
 
+namespace {
+//Number of candidates a worker matches at once
+const int SearchChunkSize = 256;
+
+SearchIndex::Fields searchFields(const Ui::SearchDialog *ui)
+{
+    SearchIndex::Fields fields;
+    if (ui->summaryCheck->isChecked()) {
+        fields |= SearchIndex::Summary;
+    }
+    if (ui->descriptionCheck->isChecked()) {
+        fields |= SearchIndex::Description;
+    }
+    if (ui->categoryCheck->isChecked()) {
+        fields |= SearchIndex::Categories;
+    }
+    if (ui->locationCheck->isChecked()) {
+        fields |= SearchIndex::Location;
+    }
+    if (ui->attendeeCheck->isChecked()) {
+        fields |= SearchIndex::Attendees;
+    }
+    return fields;
+}
+
+//Folds and matches the checked fields only, the others are empty
+bool matches(const SearchMatcher &matcher, SearchIndex::Fields fields,
+             const SearchIndex::Text &text)
+{
+    if ((fields & SearchIndex::Summary)
+        && matcher.matches(SearchMatcher::fold(text.summary))) {
+        return true;
+    }
+    if ((fields & SearchIndex::Description)
+        && matcher.matches(SearchMatcher::fold(text.description))) {
+        return true;
+    }
+    if ((fields & SearchIndex::Categories)
+        && matcher.matches(SearchMatcher::fold(text.categories))) {
+        return true;
+    }
+    if ((fields & SearchIndex::Location)
+        && matcher.matches(SearchMatcher::fold(text.location))) {
+        return true;
+    }
+    if (fields & SearchIndex::Attendees) {
+        for (const QString &attendee : text.attendees) {
+            if (matcher.matches(SearchMatcher::fold(attendee))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//Returns the indexes of the matching texts in a chunk, for QtConcurrent::mapped()
+class ChunkMatcher
+{
+public:
+    typedef QVector<int> result_type;
+
+    ChunkMatcher(const SearchMatcher &matcher, SearchIndex::Fields fields,
+                 const QSharedPointer<const QVector<SearchIndex::Text> > &texts)
+        : mMatcher(matcher)
+        , mFields(fields)
+        , mTexts(texts)
+    {
+    }
+
+    QVector<int> operator()(int offset) const
+    {
+        //A regular expression keeps the state of the last match, every chunk needs its own copy
+        const SearchMatcher matcher = mMatcher;
+        QVector<int> result;
+        const int end = qMin(offset + SearchChunkSize, mTexts->size());
+        for (int i = offset; i < end; ++i) {
+            if (matches(matcher, mFields, mTexts->at(i))) {
+                result.append(i);
+            }
+        }
+        return result;
+    }
+
+private:
+    SearchMatcher mMatcher;
+    SearchIndex::Fields mFields;
+    QSharedPointer<const QVector<SearchIndex::Text> > mTexts;
+};
+
+bool isInDateRange(const QDateTime &dt, const QDate &start, const QDate &end)
+{
+    const QDate date = dt.toLocalTime().date();
+    return date >= start && date <= end;
+}
+
+bool isTodoInDateRange(const KCalCore::Todo::Ptr &todo, const QDate &start, const QDate &end)
+{
+    return (!todo->hasStartDate() && !todo->hasDueDate())       // undated
+           || (todo->hasStartDate() && isInDateRange(todo->dtStart(), start, end))       //start dt in range
+           || (todo->hasDueDate() && isInDateRange(todo->dtDue(), start, end))       //due dt in range
+           || (todo->hasCompletedDate() && isInDateRange(todo->completed(), start, end));    //completed dt in range
+}
+}
+
 SearchDialog::SearchDialog(CalendarView *calendarview)
     : QDialog(calendarview)
     , m_ui(new Ui::SearchDialog)
     , m_calendarview(calendarview)
+    , mSearchIndex(new SearchIndex(calendarview->calendar()))
 {
     setWindowTitle(i18n("Search Calendar"));
     setModal(false);
@@ -64,11 +177,48 @@ SearchDialog::SearchDialog(CalendarView *calendarview)
 
     connect(m_ui->searchEdit, &QLineEdit::textChanged, this, &SearchDialog::searchTextChanged);
 
-    // Results list view
+    // Search as you type, once the search options stop changing for a moment
+    mSearchTimer = new QTimer(this);
+    mSearchTimer->setSingleShot(true);
+    mSearchTimer->setInterval(300);
+    connect(mSearchTimer, &QTimer::timeout, this, &SearchDialog::startSearch);
+    const QList<QCheckBox *> checkBoxes = {
+        m_ui->eventsCheck, m_ui->journalsCheck, m_ui->todosCheck,
+        m_ui->categoryCheck, m_ui->locationCheck, m_ui->descriptionCheck,
+        m_ui->summaryCheck, m_ui->attendeeCheck,
+        m_ui->inclusiveCheck, m_ui->includeUndatedTodos
+    };
+    for (QCheckBox *checkBox : checkBoxes) {
+        connect(checkBox, &QCheckBox::toggled, this, [this]() {
+            mSearchTimer->start();
+        });
+    }
+    connect(m_ui->startDate, &KDateComboBox::dateChanged, this, [this]() {
+        mSearchTimer->start();
+    });
+    connect(m_ui->endDate, &KDateComboBox::dateChanged, this, [this]() {
+        mSearchTimer->start();
+    });
+
+    // Matches found by the workers are added to the list in batches
+    mRefreshTimer = new QTimer(this);
+    mRefreshTimer->setSingleShot(true);
+    mRefreshTimer->setInterval(200);
+    connect(mRefreshTimer, &QTimer::timeout, this, &SearchDialog::refreshList);
+
+    // Results list view, formatting only the rows that are visible
     QVBoxLayout *layout = new QVBoxLayout;
     layout->setMargin(0);
-    listView = new EventViews::ListView(m_calendarview->calendar(), this);
-    layout->addWidget(listView);
+    mResultModel = new SearchResultModel(m_calendarview->calendar(), this);
+    mResultView = new QTreeView(this);
+    mResultView->setRootIsDecorated(false);
+    mResultView->setUniformRowHeights(true);
+    mResultView->setAllColumnsShowFocus(true);
+    mResultView->setModel(mResultModel);
+    mResultView->header()->setSortIndicator(SearchResultModel::StartDate, Qt::AscendingOrder);
+    mResultView->setSortingEnabled(true);
+    mResultView->setContextMenuPolicy(Qt::CustomContextMenu);
+    layout->addWidget(mResultView);
     m_ui->listViewFrame->setLayout(layout);
 
     QDialogButtonBox *buttonBox = new QDialogButtonBox(
@@ -89,13 +239,21 @@ SearchDialog::SearchDialog(CalendarView *calendarview)
 
     connect(mUser1Button, &QPushButton::clicked, this, &SearchDialog::doSearch);
 
-    // Propagate edit and delete event signals from event list view
-    connect(listView, &EventViews::ListView::showIncidenceSignal, this,
-            &SearchDialog::showIncidenceSignal);
-    connect(listView, &EventViews::ListView::editIncidenceSignal, this,
-            &SearchDialog::editIncidenceSignal);
-    connect(listView, &EventViews::ListView::deleteIncidenceSignal, this,
-            &SearchDialog::deleteIncidenceSignal);
+    // Show, edit and delete the results from the list view. Like in the other views,
+    // activating a result edits it if it can be changed and shows it otherwise.
+    connect(mResultView, &QTreeView::activated, this, [this](const QModelIndex &index) {
+        const Akonadi::Item item = mResultModel->item(index);
+        if (!item.isValid()) {
+            return;
+        }
+        if (m_calendarview->calendar()->hasRight(item, Akonadi::Collection::CanChangeItem)) {
+            Q_EMIT editIncidenceSignal(item);
+        } else {
+            Q_EMIT showIncidenceSignal(item);
+        }
+    });
+    connect(mResultView, &QTreeView::customContextMenuRequested,
+            this, &SearchDialog::showResultMenu);
 
     readConfig();
 }
@@ -103,6 +261,8 @@ SearchDialog::SearchDialog(CalendarView *calendarview)
 SearchDialog::~SearchDialog()
 {
     writeConfig();
+    abortSearch();
+    delete mSearchIndex;
     delete m_ui;
 }
 
@@ -115,15 +275,13 @@ void SearchDialog::showEvent(QShowEvent *event)
 void SearchDialog::searchTextChanged(const QString &_text)
 {
     mUser1Button->setEnabled(!_text.isEmpty());
+    mSearchTimer->start();
 }
 
 void SearchDialog::doSearch()
 {
-    QRegExp re;
-    re.setPatternSyntax(QRegExp::Wildcard);   // most people understand these better.
-    re.setCaseSensitivity(Qt::CaseInsensitive);
-    re.setPattern(m_ui->searchEdit->text());
-    if (!re.isValid()) {
+    const SearchMatcher matcher(m_ui->searchEdit->text());
+    if (!matcher.isValid()) {
         KMessageBox::sorry(
             this,
             i18n("Invalid search expression, cannot perform the search. "
@@ -132,123 +290,268 @@ void SearchDialog::doSearch()
         return;
     }
 
-    search(re);
-    listView->showIncidences(mMatchedEvents, QDate());
-    if (mMatchedEvents.isEmpty()) {
-        m_ui->numItems->setText(QString());
+    mReportEmptyResult = true;
+    startSearch();
+}
+
+void SearchDialog::updateView()
+{
+    startSearch();
+}
+
+void SearchDialog::startSearch()
+{
+    abortSearch();
+    mSearchTimer->stop();
+    mPendingMatches.clear();
+    mReplaceResults = true;
+
+    const SearchMatcher matcher(m_ui->searchEdit->text());
+    if (matcher.isEmpty() || !matcher.isValid()) {
+        mSearchMatcher = SearchMatcher();
+        mReportEmptyResult = false;
+        refreshList();
+        return;
+    }
+    mSearchMatcher = matcher;
+    mSearchCandidates = searchCandidates(matcher);
+
+    // The workers match in a copy of the text, the incidences may change meanwhile
+    const SearchIndex::Fields fields = searchFields(m_ui);
+    QSharedPointer<QVector<SearchIndex::Text> > texts(new QVector<SearchIndex::Text>);
+    texts->reserve(mSearchCandidates.count());
+    for (const KCalCore::Incidence::Ptr &incidence : qAsConst(mSearchCandidates)) {
+        texts->append(SearchIndex::text(incidence, fields));
+    }
+    QVector<int> chunks;
+    for (int offset = 0; offset < texts->size(); offset += SearchChunkSize) {
+        chunks.append(offset);
+    }
+
+    mSearchWatcher = new QFutureWatcher<QVector<int> >(this);
+    connect(mSearchWatcher, &QFutureWatcher<QVector<int> >::resultsReadyAt,
+            this, &SearchDialog::searchResultsReady);
+    connect(mSearchWatcher, &QFutureWatcher<QVector<int> >::finished,
+            this, &SearchDialog::searchFinished);
+    mSearchWatcher->setFuture(QtConcurrent::mapped(chunks, ChunkMatcher(matcher, fields, texts)));
+}
+
+void SearchDialog::abortSearch()
+{
+    mRefreshTimer->stop();
+    if (!mSearchWatcher) {
+        return;
+    }
+    mSearchWatcher->disconnect(this);
+    mSearchWatcher->cancel();
+    mSearchWatcher->deleteLater();
+    mSearchWatcher = nullptr;
+    mSearchCandidates.clear();
+}
+
+void SearchDialog::searchResultsReady(int begin, int end)
+{
+    const Akonadi::ETMCalendar::Ptr calendar = m_calendarview->calendar();
+    for (int i = begin; i < end; ++i) {
+        const QVector<int> chunkMatches = mSearchWatcher->resultAt(i);
+        for (int index : chunkMatches) {
+            mPendingMatches.append(calendar->item(mSearchCandidates.at(index)->uid()).id());
+        }
+    }
+    if (!mRefreshTimer->isActive()) {
+        mRefreshTimer->start();
+    }
+}
+
+void SearchDialog::searchFinished()
+{
+    mSearchWatcher->deleteLater();
+    mSearchWatcher = nullptr;
+    mSearchCandidates.clear();
+    mRefreshTimer->stop();
+    refreshList();
+
+    if (mReportEmptyResult && mResultModel->rowCount() == 0) {
         KMessageBox::information(
             this,
             i18n("No items were found that match your search pattern."),
             i18n("Search Results"),
             QStringLiteral("NoSearchResults"));
-    } else {
-        m_ui->numItems->setText(i18np("%1 item", "%1 items", mMatchedEvents.count()));
     }
+    mReportEmptyResult = false;
 }
 
-void SearchDialog::updateView()
+void SearchDialog::refreshList()
 {
-    QRegExp re;
-    re.setPatternSyntax(QRegExp::Wildcard);   // most people understand these better.
-    re.setCaseSensitivity(Qt::CaseInsensitive);
-    re.setPattern(m_ui->searchEdit->text());
-    if (re.isValid()) {
-        search(re);
+    if (mReplaceResults) {
+        mResultModel->clear();
+        mReplaceResults = false;
+    }
+    mResultModel->addItems(mPendingMatches);
+    mPendingMatches.clear();
+
+    const int count = mResultModel->rowCount();
+    if (count == 0) {
+        m_ui->numItems->setText(QString());
     } else {
-        mMatchedEvents.clear();
+        m_ui->numItems->setText(i18np("%1 item", "%1 items", count));
+    }
+}
+
+void SearchDialog::showResultMenu(const QPoint &pos)
+{
+    const Akonadi::Item item = mResultModel->item(mResultView->indexAt(pos));
+    if (!item.isValid()) {
+        return;
+    }
+
+    QMenu menu(this);
+    QAction *showAction = menu.addAction(QIcon::fromTheme(QStringLiteral("document-preview")),
+                                         i18n("&Show"));
+    QAction *editAction = menu.addAction(QIcon::fromTheme(QStringLiteral("document-edit")),
+                                         i18n("&Edit..."));
+    QAction *deleteAction = menu.addAction(QIcon::fromTheme(QStringLiteral("edit-delete")),
+                                           i18nc("delete this incidence", "&Delete"));
+    const Akonadi::ETMCalendar::Ptr calendar = m_calendarview->calendar();
+    editAction->setEnabled(calendar->hasRight(item, Akonadi::Collection::CanChangeItem));
+    deleteAction->setEnabled(calendar->hasRight(item, Akonadi::Collection::CanDeleteItem));
+
+    QAction *action = menu.exec(mResultView->viewport()->mapToGlobal(pos));
+    if (action == showAction) {
+        Q_EMIT showIncidenceSignal(item);
+    } else if (action == editAction) {
+        Q_EMIT editIncidenceSignal(item);
+    } else if (action == deleteAction) {
+        Q_EMIT deleteIncidenceSignal(item);
+    }
+}
+
+void SearchDialog::changeIncidenceDisplay(const Akonadi::Item &item,
+                                          Akonadi::IncidenceChanger::ChangeType changeType)
+{
+    if (mSearchMatcher.isEmpty()) {
+        return;
+    }
+    if (mSearchWatcher) {
+        // The running search may have seen the old version
+        mSearchTimer->start();
+        return;
     }
-    listView->showIncidences(mMatchedEvents, QDate());
+
+    mResultModel->removeItem(item.id());
+    if (changeType != Akonadi::IncidenceChanger::ChangeTypeDelete) {
+        const KCalCore::Incidence::Ptr incidence = CalendarSupport::incidence(item);
+        const SearchIndex::Fields fields = searchFields(m_ui);
+        if (incidence && isInSearchRange(incidence)
+            && matches(mSearchMatcher, fields, SearchIndex::text(incidence, fields))) {
+            mPendingMatches.append(item.id());
+        }
+    }
+    refreshList();
 }
 
-void SearchDialog::search(const QRegExp &re)
+KCalCore::Incidence::List SearchDialog::searchCandidates(const SearchMatcher &matcher) const
 {
     const QDate startDt = m_ui->startDate->date();
     const QDate endDt = m_ui->endDate->date();
 
-    KCalCore::Event::List events;
+    // Only incidences containing a word of the pattern are worth matching
+    QSet<QString> indexCandidates;
+    const bool useIndex = mSearchIndex->candidates(matcher.pattern(), searchFields(m_ui),
+                                                   indexCandidates);
+
+    KCalCore::Incidence::List candidates;
+    auto check = [&](const KCalCore::Incidence::Ptr &ev) {
+        Q_ASSERT(ev);
+        if (!useIndex || indexCandidates.contains(ev->instanceIdentifier())) {
+            candidates.append(ev);
+        }
+    };
+
+    const Akonadi::ETMCalendar::Ptr calendar = m_calendarview->calendar();
     if (m_ui->eventsCheck->isChecked()) {
-        events
-            = m_calendarview->calendar()->events(
-            startDt, endDt, QTimeZone::systemTimeZone(), m_ui->inclusiveCheck->isChecked());
+        const KCalCore::Event::List events
+            = calendar->events(startDt, endDt, QTimeZone::systemTimeZone(),
+                               m_ui->inclusiveCheck->isChecked());
+        for (const KCalCore::Event::Ptr &event : events) {
+            check(event);
+        }
     }
 
-    KCalCore::Todo::List todos;
-
     if (m_ui->todosCheck->isChecked()) {
         if (m_ui->includeUndatedTodos->isChecked()) {
-            const KCalCore::Todo::List alltodos = m_calendarview->calendar()->todos();
+            const KCalCore::Todo::List alltodos = calendar->todos();
             for (const KCalCore::Todo::Ptr &todo : alltodos) {
                 Q_ASSERT(todo);
-                if ((!todo->hasStartDate() && !todo->hasDueDate())       // undated
-                    || (todo->hasStartDate()
-                        && (todo->dtStart().toLocalTime().date() >= startDt)
-                        && (todo->dtStart().toLocalTime().date() <= endDt))       //start dt in range
-                    || (todo->hasDueDate()
-                        && (todo->dtDue().toLocalTime().date() >= startDt)
-                        && (todo->dtDue().toLocalTime().date() <= endDt))       //due dt in range
-                    || (todo->hasCompletedDate()
-                        && (todo->completed().toLocalTime().date() >= startDt)
-                        && (todo->completed().toLocalTime().date() <= endDt))) {    //completed dt in range
-                    todos.append(todo);
+                if (isTodoInDateRange(todo, startDt, endDt)) {
+                    check(todo);
                 }
             }
         } else {
-            QDate dt = startDt;
-            while (dt <= endDt) {
-                todos += m_calendarview->calendar()->todos(dt);
-                dt = dt.addDays(1);
+            const KCalCore::Todo::List todos
+                = calendar->todos(startDt, endDt, QTimeZone::systemTimeZone());
+            for (const KCalCore::Todo::Ptr &todo : todos) {
+                check(todo);
             }
         }
     }
 
-    KCalCore::Journal::List journals;
     if (m_ui->journalsCheck->isChecked()) {
-        QDate dt = startDt;
-        while (dt <= endDt) {
-            journals += m_calendarview->calendar()->journals(dt);
-            dt = dt.addDays(1);
+        // There is no range query for journals, they are kept by their start date
+        const KCalCore::Journal::List journals = calendar->journals();
+        for (const KCalCore::Journal::Ptr &journal : journals) {
+            if (isInDateRange(journal->dtStart(), startDt, endDt)) {
+                check(journal);
+            }
         }
     }
+    return candidates;
+}
 
-    mMatchedEvents.clear();
-    const KCalCore::Incidence::List incidences
-        = Akonadi::ETMCalendar::mergeIncidenceList(events, todos, journals);
-    for (const KCalCore::Incidence::Ptr &ev : incidences) {
-        Q_ASSERT(ev);
-        Akonadi::Item item = m_calendarview->calendar()->item(ev->uid());
-        if (m_ui->summaryCheck->isChecked()) {
-            if (re.indexIn(ev->summary()) != -1) {
-                mMatchedEvents.append(item);
-                continue;
-            }
+bool SearchDialog::isInSearchRange(const KCalCore::Incidence::Ptr &incidence) const
+{
+    const QDate startDt = m_ui->startDate->date();
+    const QDate endDt = m_ui->endDate->date();
+    const QDateTime start(startDt, QTime(0, 0), QTimeZone::systemTimeZone());
+    const QDateTime end(endDt, QTime(23, 59, 59, 999), QTimeZone::systemTimeZone());
+
+    switch (incidence->type()) {
+    case KCalCore::Incidence::TypeEvent:
+    {
+        if (!m_ui->eventsCheck->isChecked()) {
+            return false;
         }
-        if (m_ui->descriptionCheck->isChecked()) {
-            if (re.indexIn(ev->description()) != -1) {
-                mMatchedEvents.append(item);
-                continue;
-            }
+        // Same as the range query: occurrences starting in [from, to] are in the range
+        const KCalCore::Event::Ptr event = incidence.staticCast<KCalCore::Event>();
+        const qint64 duration = event->dtStart().secsTo(event->dtEnd());
+        const bool inclusive = m_ui->inclusiveCheck->isChecked();
+        const QDateTime from = inclusive ? start : start.addSecs(-duration);
+        const QDateTime to = inclusive ? end.addSecs(-duration) : end;
+        if (event->recurs()) {
+            return !event->recurrence()->timesInInterval(from, to).isEmpty();
         }
-        if (m_ui->categoryCheck->isChecked()) {
-            if (re.indexIn(ev->categoriesStr()) != -1) {
-                mMatchedEvents.append(item);
-                continue;
-            }
+        return event->dtStart() >= from && event->dtStart() <= to;
+    }
+    case KCalCore::Incidence::TypeTodo:
+    {
+        if (!m_ui->todosCheck->isChecked()) {
+            return false;
         }
-        if (m_ui->locationCheck->isChecked()) {
-            if (re.indexIn(ev->location()) != -1) {
-                mMatchedEvents.append(item);
-                continue;
-            }
+        const KCalCore::Todo::Ptr todo = incidence.staticCast<KCalCore::Todo>();
+        if (m_ui->includeUndatedTodos->isChecked()) {
+            return isTodoInDateRange(todo, startDt, endDt);
         }
-        if (m_ui->attendeeCheck->isChecked()) {
-            const KCalCore::Attendee::List lstAttendees = ev->attendees();
-            for (const KCalCore::Attendee::Ptr &attendee : lstAttendees) {
-                if (re.indexIn(attendee->fullName()) != -1) {
-                    mMatchedEvents.append(item);
-                    break;
-                }
-            }
+        if (todo->recurs()) {
+            return !todo->recurrence()->timesInInterval(start, end).isEmpty();
         }
+        const QDateTime dt = todo->hasDueDate() ? todo->dtDue() : todo->dtStart();
+        return dt.isValid() && isInDateRange(dt, startDt, endDt);
+    }
+    case KCalCore::Incidence::TypeJournal:
+        return m_ui->journalsCheck->isChecked()
+               && isInDateRange(incidence->dtStart(), startDt, endDt);
+    default:
+        return false;
     }
 }
 
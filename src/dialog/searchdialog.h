@@ -27,23 +27,26 @@
 #ifndef KORG_SEARCHDIALOG_H
 #define KORG_SEARCHDIALOG_H
 
+#include "searchmatcher.h"
+
+#include <KCalCore/Incidence>
+#include <Akonadi/Calendar/IncidenceChanger>
+
 #include <QDialog>
+#include <QFutureWatcher>
+#include <QVector>
 #include <item.h>
 class QPushButton;
+class QTimer;
+class QTreeView;
 class CalendarView;
+class SearchIndex;
+class SearchResultModel;
 
 namespace Ui {
 class SearchDialog;
 }
 
-namespace EventViews {
-class ListView;
-}
-
-namespace KCalCore {
-class Incidence;
-}
-
 class SearchDialog : public QDialog
 {
     Q_OBJECT
@@ -54,10 +57,11 @@ public:
     void updateView();
 
 public Q_SLOTS:
-    void changeIncidenceDisplay(KCalCore::Incidence *, int)
-    {
-        updateView();
-    }
+    /**
+     * Adds, updates or removes @p item in the search results, without searching again.
+     */
+    void changeIncidenceDisplay(const Akonadi::Item &item,
+                                Akonadi::IncidenceChanger::ChangeType changeType);
 
 Q_SIGNALS:
     void showIncidenceSignal(const Akonadi::Item &);
@@ -71,15 +75,35 @@ private:
     void doSearch();
     void searchTextChanged(const QString &_text);
     void slotHelpRequested();
-    void search(const QRegExp &);
+    void startSearch();
+    void abortSearch();
+    void searchResultsReady(int begin, int end);
+    void searchFinished();
+    void refreshList();
+    void showResultMenu(const QPoint &pos);
+    KCalCore::Incidence::List searchCandidates(const SearchMatcher &matcher) const;
+    bool isInSearchRange(const KCalCore::Incidence::Ptr &incidence) const;
     void readConfig();
     void writeConfig();
 
     Ui::SearchDialog *m_ui = nullptr;
     CalendarView *m_calendarview = nullptr; // parent
-    Akonadi::Item::List mMatchedEvents;
-    EventViews::ListView *listView = nullptr;
+    //Matches not added to the result model yet
+    QVector<Akonadi::Item::Id> mPendingMatches;
+    //Whether the result model still holds the results of the previous search
+    bool mReplaceResults = false;
+    SearchResultModel *mResultModel = nullptr;
+    QTreeView *mResultView = nullptr;
     QPushButton *mUser1Button = nullptr;
+    SearchIndex *mSearchIndex = nullptr;
+    QTimer *mSearchTimer = nullptr;
+    QTimer *mRefreshTimer = nullptr;
+    //Matches the candidates in chunks in worker threads, null when no search is running
+    QFutureWatcher<QVector<int> > *mSearchWatcher = nullptr;
+    KCalCore::Incidence::List mSearchCandidates;
+    //Pattern of the last search, empty when there are no results to keep up to date
+    SearchMatcher mSearchMatcher;
+    bool mReportEmptyResult = false;
 };
 
 #endif
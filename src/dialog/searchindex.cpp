@@ -0,0 +1,190 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+  As a special exception, permission is given to link this program
+  with any edition of Qt, and distribute the resulting executable,
+  without including the source code for Qt in the source distribution.
+*/
+
+#include "searchindex.h"
+#include "searchmatcher.h"
+
+SearchIndex::SearchIndex(const KCalCore::Calendar::Ptr &calendar)
+    : mCalendar(calendar)
+{
+    const KCalCore::Incidence::List incidences = mCalendar->incidences();
+    for (const KCalCore::Incidence::Ptr &incidence : incidences) {
+        addIncidence(incidence);
+    }
+    mCalendar->registerObserver(this);
+}
+
+SearchIndex::~SearchIndex()
+{
+    mCalendar->unregisterObserver(this);
+}
+
+QStringList SearchIndex::words(const QString &text)
+{
+    QStringList result;
+    const QString folded = SearchMatcher::fold(text);
+    int start = -1;
+    for (int i = 0; i <= folded.size(); ++i) {
+        if (i < folded.size() && folded.at(i).isLetterOrNumber()) {
+            if (start < 0) {
+                start = i;
+            }
+        } else if (start >= 0) {
+            result.append(folded.mid(start, i - start));
+            start = -1;
+        }
+    }
+    return result;
+}
+
+bool SearchIndex::candidates(const QString &pattern, Fields fields,
+                             QSet<QString> &instances) const
+{
+    //Every text matching the pattern contains the words of its literal parts,
+    //so looking up the longest of them is enough.
+    QString longest;
+    QString literal;
+    bool inSet = false;
+    for (int i = 0; i <= pattern.size(); ++i) {
+        const QChar c = i < pattern.size() ? pattern.at(i) : QChar(QLatin1Char('*'));
+        if (inSet) {
+            inSet = c != QLatin1Char(']');
+            continue;
+        }
+        if (c == QLatin1Char('*') || c == QLatin1Char('?') || c == QLatin1Char('[')) {
+            const QStringList literalWords = words(literal);
+            for (const QString &word : literalWords) {
+                if (word.size() > longest.size()) {
+                    longest = word;
+                }
+            }
+            literal.clear();
+            inSet = c == QLatin1Char('[');
+        } else {
+            literal.append(c);
+        }
+    }
+    if (longest.isEmpty()) {
+        return false;
+    }
+
+    //The dialog matches anywhere in a field, so expand to all words containing it
+    for (auto it = mPostings.cbegin(), end = mPostings.cend(); it != end; ++it) {
+        if (!it.key().contains(longest)) {
+            continue;
+        }
+        const QHash<QString, Fields> &postings = it.value();
+        for (auto posting = postings.cbegin(), postingsEnd = postings.cend();
+             posting != postingsEnd; ++posting) {
+            if (posting.value() & fields) {
+                instances.insert(posting.key());
+            }
+        }
+    }
+    return true;
+}
+
+SearchIndex::Text SearchIndex::text(const KCalCore::Incidence::Ptr &incidence, Fields fields)
+{
+    //Copies of the strings are cheap, they are shared with the incidence
+    Text text;
+    if (fields & Summary) {
+        text.summary = incidence->summary();
+    }
+    if (fields & Description) {
+        text.description = incidence->description();
+    }
+    if (fields & Categories) {
+        text.categories = incidence->categoriesStr();
+    }
+    if (fields & Location) {
+        text.location = incidence->location();
+    }
+    if (fields & Attendees) {
+        const KCalCore::Attendee::List attendees = incidence->attendees();
+        text.attendees.reserve(attendees.count());
+        for (const KCalCore::Attendee::Ptr &attendee : attendees) {
+            text.attendees.append(attendee->fullName());
+        }
+    }
+    return text;
+}
+
+void SearchIndex::calendarIncidenceAdded(const KCalCore::Incidence::Ptr &incidence)
+{
+    addIncidence(incidence);
+}
+
+void SearchIndex::calendarIncidenceChanged(const KCalCore::Incidence::Ptr &incidence)
+{
+    addIncidence(incidence);
+}
+
+void SearchIndex::calendarIncidenceDeleted(const KCalCore::Incidence::Ptr &incidence,
+                                           const KCalCore::Calendar *calendar)
+{
+    Q_UNUSED(calendar);
+    removeIncidence(incidence->instanceIdentifier());
+}
+
+void SearchIndex::addIncidence(const KCalCore::Incidence::Ptr &incidence)
+{
+    const QString instance = incidence->instanceIdentifier();
+    removeIncidence(instance);
+
+    addWords(instance, incidence->summary(), Summary);
+    addWords(instance, incidence->description(), Description);
+    addWords(instance, incidence->categoriesStr(), Categories);
+    addWords(instance, incidence->location(), Location);
+    const KCalCore::Attendee::List attendees = incidence->attendees();
+    for (const KCalCore::Attendee::Ptr &attendee : attendees) {
+        addWords(instance, attendee->fullName(), Attendees);
+    }
+}
+
+void SearchIndex::removeIncidence(const QString &instance)
+{
+    const QSet<QString> incidenceWords = mWords.take(instance);
+    for (const QString &word : incidenceWords) {
+        auto it = mPostings.find(word);
+        if (it == mPostings.end()) {
+            continue;
+        }
+        it->remove(instance);
+        if (it->isEmpty()) {
+            mPostings.erase(it);
+        }
+    }
+}
+
+void SearchIndex::addWords(const QString &instance, const QString &text, Field field)
+{
+    const QStringList textWords = words(text);
+    if (textWords.isEmpty()) {
+        return;
+    }
+    QSet<QString> &incidenceWords = mWords[instance];
+    for (const QString &word : textWords) {
+        mPostings[word][instance] |= field;
+        incidenceWords.insert(word);
+    }
+}
@@ -0,0 +1,103 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+  As a special exception, permission is given to link this program
+  with any edition of Qt, and distribute the resulting executable,
+  without including the source code for Qt in the source distribution.
+*/
+
+#ifndef KORG_SEARCHINDEX_H
+#define KORG_SEARCHINDEX_H
+
+#include <KCalCore/Calendar>
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+/**
+ * Index of the words in the incidence fields the search dialog searches in.
+ *
+ * The index is built from the calendar on construction and kept up to date
+ * as an observer of the calendar.
+ */
+class SearchIndex : public KCalCore::Calendar::CalendarObserver
+{
+public:
+    enum Field {
+        Summary = 0x01,
+        Description = 0x02,
+        Categories = 0x04,
+        Location = 0x08,
+        Attendees = 0x10
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    /**
+     * The fields of an incidence the search dialog matches in, as they are. They are
+     * folded with SearchMatcher::fold() by the worker threads which match them.
+     */
+    struct Text {
+        QString summary;
+        QString description;
+        QString categories;
+        QString location;
+        QStringList attendees;
+    };
+
+    explicit SearchIndex(const KCalCore::Calendar::Ptr &calendar);
+    ~SearchIndex() override;
+
+    /**
+     * Looks up the incidences which may match the wildcard @p pattern in one of @p fields,
+     * by their instance identifier.
+     *
+     * @return false if the pattern contains no word the index can be asked for,
+     * in which case all incidences have to be checked.
+     */
+    bool candidates(const QString &pattern, Fields fields, QSet<QString> &instances) const;
+
+    /**
+     * Returns the text of @p incidence in @p fields, the other fields are left empty.
+     */
+    static Text text(const KCalCore::Incidence::Ptr &incidence, Fields fields);
+
+    /**
+     * Splits @p text into the folded words the index is built from.
+     */
+    static QStringList words(const QString &text);
+
+private:
+    void calendarIncidenceAdded(const KCalCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceChanged(const KCalCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceDeleted(const KCalCore::Incidence::Ptr &incidence,
+                                  const KCalCore::Calendar *calendar) override;
+
+    void addIncidence(const KCalCore::Incidence::Ptr &incidence);
+    void removeIncidence(const QString &instance);
+    void addWords(const QString &instance, const QString &text, Field field);
+
+    KCalCore::Calendar::Ptr mCalendar;
+    //Fields containing a word, by word and instance identifier
+    QHash<QString, QHash<QString, Fields> > mPostings;
+    //Words of an incidence, to drop its postings again when it changes
+    QHash<QString, QSet<QString> > mWords;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(SearchIndex::Fields)
+
+#endif
@@ -0,0 +1,110 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+  As a special exception, permission is given to link this program
+  with any edition of Qt, and distribute the resulting executable,
+  without including the source code for Qt in the source distribution.
+*/
+
+#include "searchmatcher.h"
+
+static int globIndexIn(const QString &text, const QString &part, int from)
+{
+    const int last = text.size() - part.size();
+    for (int i = from; i <= last; ++i) {
+        int j = 0;
+        while (j < part.size()
+               && (part.at(j) == QLatin1Char('?') || part.at(j) == text.at(i + j))) {
+            ++j;
+        }
+        if (j == part.size()) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+SearchMatcher::SearchMatcher(const QString &pattern)
+    : mPattern(pattern)
+    , mKind(Literal)
+{
+    if (pattern.contains(QLatin1Char('['))) {
+        mKind = RegExp;
+        mRegExp.setPatternSyntax(QRegExp::Wildcard);
+        mRegExp.setCaseSensitivity(Qt::CaseInsensitive);
+        mRegExp.setPattern(fold(pattern));
+        return;
+    }
+
+    //The pattern may match anywhere, so leading and trailing '*' don't matter
+    //and a pattern like "*meeting*" is searched for as plain text.
+    mParts = fold(pattern).split(QLatin1Char('*'), QString::SkipEmptyParts);
+    if (mParts.size() > 1 || pattern.contains(QLatin1Char('?'))) {
+        mKind = Glob;
+    } else {
+        mLiteral.setPattern(mParts.value(0));
+    }
+}
+
+QString SearchMatcher::pattern() const
+{
+    return mPattern;
+}
+
+SearchMatcher::Kind SearchMatcher::kind() const
+{
+    return mKind;
+}
+
+bool SearchMatcher::isEmpty() const
+{
+    return mPattern.isEmpty();
+}
+
+bool SearchMatcher::isValid() const
+{
+    return mKind != RegExp || mRegExp.isValid();
+}
+
+bool SearchMatcher::matches(const QString &foldedText) const
+{
+    switch (mKind) {
+    case Literal:
+        return mLiteral.indexIn(foldedText) != -1;
+    case Glob:
+    {
+        //Finding each part as early as possible leaves the most room for the next
+        int from = 0;
+        for (const QString &part : mParts) {
+            const int index = globIndexIn(foldedText, part, from);
+            if (index < 0) {
+                return false;
+            }
+            from = index + part.size();
+        }
+        return true;
+    }
+    case RegExp:
+        return mRegExp.indexIn(foldedText) != -1;
+    }
+    return false;
+}
+
+QString SearchMatcher::fold(const QString &text)
+{
+    return text.toCaseFolded();
+}
@@ -0,0 +1,73 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+  As a special exception, permission is given to link this program
+  with any edition of Qt, and distribute the resulting executable,
+  without including the source code for Qt in the source distribution.
+*/
+
+#ifndef KORG_SEARCHMATCHER_H
+#define KORG_SEARCHMATCHER_H
+
+#include <QRegExp>
+#include <QStringList>
+#include <QStringMatcher>
+
+/**
+ * A wildcard pattern as entered in the search dialog, compiled once to match
+ * it case insensitively anywhere in many texts.
+ *
+ * Plain text is searched for with a QStringMatcher, patterns with only '*' and
+ * '?' are matched piecewise, and only character sets need a QRegExp.
+ *
+ * The texts have to be folded with fold() first. A matcher can be used from
+ * several threads at once, except for the RegExp kind, which needs a copy
+ * per thread.
+ */
+class SearchMatcher
+{
+public:
+    enum Kind {
+        Literal,
+        Glob,
+        RegExp
+    };
+
+    explicit SearchMatcher(const QString &pattern = QString());
+
+    QString pattern() const;
+    Kind kind() const;
+    bool isEmpty() const;
+    bool isValid() const;
+
+    /**
+     * Returns true if the pattern is found in @p foldedText.
+     */
+    bool matches(const QString &foldedText) const;
+
+    static QString fold(const QString &text);
+
+private:
+    QString mPattern;
+    Kind mKind;
+    QStringMatcher mLiteral;
+    //Folded parts between the '*' of a glob, '?' matches any character in them
+    QStringList mParts;
+    QRegExp mRegExp;
+};
+
+#endif
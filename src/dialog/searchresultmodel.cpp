@@ -0,0 +1,353 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+  As a special exception, permission is given to link this program
+  with any edition of Qt, and distribute the resulting executable,
+  without including the source code for Qt in the source distribution.
+*/
+
+#include "searchresultmodel.h"
+
+#include <CalendarSupport/Utils>
+
+#include <KCalCore/Event>
+#include <KCalCore/Todo>
+
+#include <KLocalizedString>
+
+#include <QHash>
+#include <QIcon>
+#include <QLocale>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+QDateTime startDateTime(const KCalCore::Incidence::Ptr &incidence)
+{
+    if (incidence->type() == KCalCore::Incidence::TypeTodo
+        && !incidence.staticCast<KCalCore::Todo>()->hasStartDate()) {
+        return QDateTime();
+    }
+    return incidence->dtStart();
+}
+
+//The due date of to-dos, nothing for journals
+QDateTime endDateTime(const KCalCore::Incidence::Ptr &incidence)
+{
+    switch (incidence->type()) {
+    case KCalCore::Incidence::TypeEvent:
+        return incidence.staticCast<KCalCore::Event>()->dtEnd();
+    case KCalCore::Incidence::TypeTodo:
+    {
+        const KCalCore::Todo::Ptr todo = incidence.staticCast<KCalCore::Todo>();
+        return todo->hasDueDate() ? todo->dtDue() : QDateTime();
+    }
+    default:
+        return QDateTime();
+    }
+}
+
+QString dateText(const QDateTime &dt)
+{
+    return dt.isValid() ? QLocale().toString(dt.toLocalTime().date(), QLocale::ShortFormat)
+           : QString();
+}
+
+QString timeText(const QDateTime &dt, bool allDay)
+{
+    return dt.isValid() && !allDay
+           ? QLocale().toString(dt.toLocalTime().time(), QLocale::ShortFormat)
+           : QString();
+}
+}
+
+SearchResultModel::SearchResultModel(const Akonadi::ETMCalendar::Ptr &calendar, QObject *parent)
+    : QAbstractTableModel(parent)
+    , mCalendar(calendar)
+{
+}
+
+void SearchResultModel::clear()
+{
+    if (mRows.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    mRows.clear();
+    mRows.squeeze();
+    mIds.clear();
+    mIds.squeeze();
+    endResetModel();
+}
+
+void SearchResultModel::addItems(const QVector<Akonadi::Item::Id> &ids)
+{
+    QVector<Row> rows;
+    rows.reserve(ids.count());
+    for (Akonadi::Item::Id id : ids) {
+        if (mIds.contains(id)) {
+            continue;
+        }
+        mIds.insert(id);
+        Row row;
+        row.id = id;
+        setSortKey(row);
+        rows.append(row);
+    }
+    if (rows.isEmpty()) {
+        return;
+    }
+    std::stable_sort(rows.begin(), rows.end(), [this](const Row &left, const Row &right) {
+        return precedes(left, right);
+    });
+
+    //Append the sorted rows and merge them into place, which is linear
+    const int first = mRows.count();
+    beginInsertRows(QModelIndex(), first, first + rows.count() - 1);
+    mRows += rows;
+    endInsertRows();
+    if (first > 0) {
+        reorderRows([this, first]() {
+            std::inplace_merge(mRows.begin(), mRows.begin() + first, mRows.end(),
+                               [this](const Row &left, const Row &right) {
+                return precedes(left, right);
+            });
+        });
+    }
+}
+
+void SearchResultModel::removeItem(Akonadi::Item::Id id)
+{
+    if (!mIds.remove(id)) {
+        return;
+    }
+    for (int i = mRows.count() - 1; i >= 0; --i) {
+        if (mRows.at(i).id == id) {
+            beginRemoveRows(QModelIndex(), i, i);
+            mRows.remove(i);
+            endRemoveRows();
+        }
+    }
+}
+
+Akonadi::Item SearchResultModel::item(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.row() >= mRows.count()) {
+        return Akonadi::Item();
+    }
+    return mCalendar->item(mRows.at(index.row()).id);
+}
+
+int SearchResultModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : mRows.count();
+}
+
+int SearchResultModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant SearchResultModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= mRows.count()
+        || (role != Qt::DisplayRole && role != Qt::DecorationRole)) {
+        return QVariant();
+    }
+    const KCalCore::Incidence::Ptr incidence = this->incidence(mRows.at(index.row()).id);
+    if (!incidence) {
+        return QVariant();
+    }
+
+    if (role == Qt::DecorationRole) {
+        switch (index.column()) {
+        case Summary:
+            return QIcon::fromTheme(incidence->iconName());
+        case Reminder:
+            return incidence->hasEnabledAlarms()
+                   ? QIcon::fromTheme(QStringLiteral("appointment-reminder")) : QVariant();
+        case Recurs:
+            return incidence->recurs()
+                   ? QIcon::fromTheme(QStringLiteral("appointment-recurring")) : QVariant();
+        default:
+            return QVariant();
+        }
+    }
+
+    switch (index.column()) {
+    case Summary:
+        return incidence->summary();
+    case Reminder:
+    case Recurs:
+        return QVariant();
+    case StartDate:
+        return dateText(startDateTime(incidence));
+    case StartTime:
+        return timeText(startDateTime(incidence), incidence->allDay());
+    case EndDate:
+        return dateText(endDateTime(incidence));
+    case EndTime:
+        return timeText(endDateTime(incidence), incidence->allDay());
+    case Categories:
+        return incidence->categoriesStr();
+    default:
+        return QVariant();
+    }
+}
+
+QVariant SearchResultModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case Summary:
+        return i18n("Summary");
+    case Reminder:
+        return i18n("Reminder");
+    case Recurs:
+        return i18n("Recurs");
+    case StartDate:
+        return i18n("Start Date");
+    case StartTime:
+        return i18n("Start Time");
+    case EndDate:
+        return i18n("End Date");
+    case EndTime:
+        return i18n("End Time");
+    case Categories:
+        return i18n("Categories");
+    default:
+        return QVariant();
+    }
+}
+
+void SearchResultModel::sort(int column, Qt::SortOrder order)
+{
+    if (column < 0 || column >= ColumnCount) {
+        return;
+    }
+    const bool keysChanged = column != mSortColumn;
+    mSortColumn = column;
+    mSortOrder = order;
+    if (keysChanged) {
+        for (Row &row : mRows) {
+            setSortKey(row);
+        }
+    }
+    reorderRows([this]() {
+        std::stable_sort(mRows.begin(), mRows.end(), [this](const Row &left, const Row &right) {
+            return precedes(left, right);
+        });
+    });
+}
+
+KCalCore::Incidence::Ptr SearchResultModel::incidence(Akonadi::Item::Id id) const
+{
+    return CalendarSupport::incidence(mCalendar->item(id));
+}
+
+void SearchResultModel::setSortKey(Row &row) const
+{
+    row.time = std::numeric_limits<qint64>::max();
+    row.text.clear();
+    const KCalCore::Incidence::Ptr incidence = this->incidence(row.id);
+    if (!incidence) {
+        return;
+    }
+    switch (mSortColumn) {
+    case Summary:
+        row.text = incidence->summary();
+        break;
+    case Categories:
+        row.text = incidence->categoriesStr();
+        break;
+    case Reminder:
+        row.time = incidence->hasEnabledAlarms() ? 1 : 0;
+        break;
+    case Recurs:
+        row.time = incidence->recurs() ? 1 : 0;
+        break;
+    case StartDate:
+    case StartTime:
+    {
+        const QDateTime dt = startDateTime(incidence);
+        if (dt.isValid()) {
+            row.time = dt.toMSecsSinceEpoch();
+        }
+        break;
+    }
+    case EndDate:
+    case EndTime:
+    {
+        const QDateTime dt = endDateTime(incidence);
+        if (dt.isValid()) {
+            row.time = dt.toMSecsSinceEpoch();
+        }
+        break;
+    }
+    }
+}
+
+bool SearchResultModel::precedes(const Row &left, const Row &right) const
+{
+    const Row &first = mSortOrder == Qt::AscendingOrder ? left : right;
+    const Row &second = mSortOrder == Qt::AscendingOrder ? right : left;
+    if (mSortColumn == Summary || mSortColumn == Categories) {
+        return QString::localeAwareCompare(first.text, second.text) < 0;
+    }
+    return first.time < second.time;
+}
+
+void SearchResultModel::reorderRows(const std::function<void()> &reorder)
+{
+    Q_EMIT layoutAboutToBeChanged(QList<QPersistentModelIndex>(),
+                                  QAbstractItemModel::VerticalSortHint);
+
+    //Remember the items of the selection and current index of the view
+    const QModelIndexList persistent = persistentIndexList();
+    QVector<Akonadi::Item::Id> persistentIds;
+    persistentIds.reserve(persistent.count());
+    for (const QModelIndex &index : persistent) {
+        persistentIds.append(mRows.at(index.row()).id);
+    }
+
+    reorder();
+
+    if (!persistent.isEmpty()) {
+        QHash<Akonadi::Item::Id, int> rowOfId;
+        rowOfId.reserve(persistentIds.count());
+        for (Akonadi::Item::Id id : qAsConst(persistentIds)) {
+            rowOfId.insert(id, -1);
+        }
+        for (int i = 0; i < mRows.count(); ++i) {
+            const auto it = rowOfId.find(mRows.at(i).id);
+            if (it != rowOfId.end()) {
+                it.value() = i;
+            }
+        }
+        QModelIndexList moved;
+        moved.reserve(persistent.count());
+        for (int i = 0; i < persistent.count(); ++i) {
+            moved.append(index(rowOfId.value(persistentIds.at(i)), persistent.at(i).column()));
+        }
+        changePersistentIndexList(persistent, moved);
+    }
+
+    Q_EMIT layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+}
@@ -0,0 +1,111 @@
+/*
+  This file is part of KOrganizer.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+  As a special exception, permission is given to link this program
+  with any edition of Qt, and distribute the resulting executable,
+  without including the source code for Qt in the source distribution.
+*/
+
+#ifndef KORG_SEARCHRESULTMODEL_H
+#define KORG_SEARCHRESULTMODEL_H
+
+#include <Akonadi/Calendar/ETMCalendar>
+
+#include <QAbstractTableModel>
+#include <QSet>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * Flat list of the incidences found by the search dialog.
+ *
+ * Only the item id and the key of the sort column are kept for each row.
+ * The incidence is looked up in the calendar and the text of a cell is
+ * formatted when the view asks for it, so that large results cost little
+ * memory and show up at once.
+ */
+class SearchResultModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column {
+        Summary = 0,
+        Reminder,
+        Recurs,
+        StartDate,
+        StartTime,
+        EndDate,
+        EndTime,
+        Categories,
+        ColumnCount
+    };
+
+    explicit SearchResultModel(const Akonadi::ETMCalendar::Ptr &calendar,
+                               QObject *parent = nullptr);
+
+    /**
+     * Removes all rows.
+     */
+    void clear();
+
+    /**
+     * Adds the items with the given @p ids, at their place in the current sort order.
+     * Items which are listed already are skipped.
+     */
+    void addItems(const QVector<Akonadi::Item::Id> &ids);
+
+    /**
+     * Removes the rows of the item with @p id, if there are any.
+     */
+    void removeItem(Akonadi::Item::Id id);
+
+    Akonadi::Item item(const QModelIndex &index) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+private:
+    struct Row {
+        Akonadi::Item::Id id;
+        //Key of the date and time columns, in msecs since the epoch, or 0 and 1
+        //for the reminder and recurrence flags
+        qint64 time;
+        //Key of the text columns
+        QString text;
+    };
+
+    KCalCore::Incidence::Ptr incidence(Akonadi::Item::Id id) const;
+    void setSortKey(Row &row) const;
+    //Whether @p left comes before @p right in the current sort order
+    bool precedes(const Row &left, const Row &right) const;
+    //Runs @p reorder on the rows, keeping the persistent indexes on their items
+    void reorderRows(const std::function<void()> &reorder);
+
+    Akonadi::ETMCalendar::Ptr mCalendar;
+    QVector<Row> mRows;
+    //Items of the rows, a recurring series and its exceptions share one item
+    QSet<Akonadi::Item::Id> mIds;
+    int mSortColumn = StartDate;
+    Qt::SortOrder mSortOrder = Qt::AscendingOrder;
+};
+
+#endif
@@ -39,6 +39,8 @@
 #include <klocalizedstring.h>
 #include "korganizer_debug.h"
 
+#include <QTimer>
+
 using namespace KOrg;
 
 SearchCollectionHelper::SearchCollectionHelper(QObject *parent)
@@ -46,12 +48,22 @@ SearchCollectionHelper::SearchCollectionHelper(QObject *parent)
 {
     mIdentityManager = KIdentityManagement::IdentityManager::self();
     setupSearchCollections();
+
+    //Saving the identities can emit changed() several times, only update the searches once
+    mIdentitiesChangedTimer = new QTimer(this);
+    mIdentitiesChangedTimer->setSingleShot(true);
+    mIdentitiesChangedTimer->setInterval(500);
+    connect(mIdentitiesChangedTimer, &QTimer::timeout, this,
+            &SearchCollectionHelper::onIdentitiesChanged);
     connect(mIdentityManager, QOverload<>::of(
-                &KIdentityManagement::IdentityManager::changed), this,
-            &SearchCollectionHelper::updateOpenInvitation);
-    connect(mIdentityManager, QOverload<>::of(
-                &KIdentityManagement::IdentityManager::changed), this,
-            &SearchCollectionHelper::updateDeclinedInvitation);
+                &KIdentityManagement::IdentityManager::changed), mIdentitiesChangedTimer,
+            QOverload<>::of(&QTimer::start));
+}
+
+void SearchCollectionHelper::onIdentitiesChanged()
+{
+    updateOpenInvitation();
+    updateDeclinedInvitation();
 }
 
 void SearchCollectionHelper::setupSearchCollections()
@@ -84,15 +96,18 @@ void SearchCollectionHelper::onSearchCollectionsFetched(KJob *job)
     updateDeclinedInvitation();
 }
 
-void SearchCollectionHelper::updateSearchCollection(Akonadi::Collection col,
+void SearchCollectionHelper::updateSearchCollection(Akonadi::Collection &col,
                                                     KCalCore::Attendee::PartStat status,
                                                     const QString &name, const QString &displayName)
 {
     // Update or create search collections
 
     Akonadi::SearchQuery query(Akonadi::SearchTerm::RelOr);
-    const QStringList lstEmails = mIdentityManager->allEmails();
-    for (const QString &email : lstEmails) {
+    //Sorted, so the same set of identities always results in the same query
+    QStringList lstEmails = mIdentityManager->allEmails();
+    lstEmails.sort();
+    lstEmails.removeDuplicates();
+    for (const QString &email : qAsConst(lstEmails)) {
         if (!email.isEmpty()) {
             query.addTerm(Akonadi::IncidenceSearchTerm(Akonadi::IncidenceSearchTerm::PartStatus,
                                                        QString(email + QString::number(status))));
@@ -109,11 +124,26 @@ void SearchCollectionHelper::updateSearchCollection(Akonadi::Collection col,
                 &SearchCollectionHelper::createSearchJobFinished);
         qCDebug(KORGANIZER_LOG) << "We have to create a " << name << " virtual Collection";
     } else {
+        const QString queryString = QString::fromLatin1(query.toJSON());
+        //Modifying the search makes Akonadi run it again over all items, so only do so if something changed.
+        //The collection holds what we stored last time, e.g. on the previous start.
+        const Akonadi::PersistentSearchAttribute *currentAttribute
+            = col.attribute<Akonadi::PersistentSearchAttribute>();
+        const Akonadi::EntityDisplayAttribute *currentDisplayName
+            = col.attribute<Akonadi::EntityDisplayAttribute>();
+        if (currentAttribute && currentDisplayName && col.enabled()
+            && !currentAttribute->isRemoteSearchEnabled()
+            && currentAttribute->queryString() == queryString
+            && currentDisplayName->displayName() == displayName) {
+            qCDebug(KORGANIZER_LOG) << name << " (" << col.id() << ") virtual Collection is up to date";
+            return;
+        }
+
         Akonadi::PersistentSearchAttribute *attribute
             = col.attribute<Akonadi::PersistentSearchAttribute>(Akonadi::Collection::AddIfMissing);
         Akonadi::EntityDisplayAttribute *displayname
             = col.attribute<Akonadi::EntityDisplayAttribute >(Akonadi::Collection::AddIfMissing);
-        attribute->setQueryString(QString::fromLatin1(query.toJSON()));
+        attribute->setQueryString(queryString);
         attribute->setRemoteSearchEnabled(false);
         displayname->setDisplayName(displayName);
         col.setEnabled(true);
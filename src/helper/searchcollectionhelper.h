@@ -33,6 +33,7 @@
 #include <KIdentityManagement/KIdentityManagement/IdentityManager>
 
 class KJob;
+class QTimer;
 
 namespace KOrg {
 class SearchCollectionHelper : public QObject
@@ -43,6 +44,7 @@ public:
 
 private:
     void onSearchCollectionsFetched(KJob *job);
+    void onIdentitiesChanged();
     void updateOpenInvitation();
     void updateDeclinedInvitation();
 
@@ -50,11 +52,12 @@ private:
     void modifyResult(KJob *job);
 
     void setupSearchCollections();
-    void updateSearchCollection(Akonadi::Collection col, KCalCore::Attendee::PartStat status,
+    void updateSearchCollection(Akonadi::Collection &col, KCalCore::Attendee::PartStat status,
                                 const QString &name, const QString &displayName);
 
 private:
     KIdentityManagement::IdentityManager *mIdentityManager = nullptr;
+    QTimer *mIdentitiesChangedTimer = nullptr;
     Akonadi::Collection mOpenInvitationCollection;
     Akonadi::Collection mDeclineCollection;
 };
@@ -53,6 +53,12 @@ public:
     QDateTime endDateTime;
     QDateTime actualStartDateTime;
     QDateTime actualEndDateTime;
+
+    // What the view showed the last time it was brought up to date
+    quint64 upToDateGeneration = 0;
+    QDate upToDateStart;
+    QDate upToDateEnd;
+    QDate upToDatePreferredMonth;
 };
 
 BaseView::BaseView(QWidget *parent)
@@ -71,6 +77,7 @@ void BaseView::setCalendar(const Akonadi::ETMCalendar::Ptr &calendar)
 {
     if (d->calendar != calendar) {
         d->calendar = calendar;
+        d->upToDateGeneration = 0;
     }
 }
 
@@ -220,6 +227,11 @@ bool BaseView::supportsZoom()
     return false;
 }
 
+bool BaseView::observesCalendar() const
+{
+    return false;
+}
+
 bool BaseView::supportsDateRangeSelection()
 {
     return true;
@@ -245,3 +257,22 @@ EventViews::EventView::Changes BaseView::changes() const
 {
     return d->mChanges;
 }
+
+void BaseView::setUpToDate(quint64 generation, const QDate &start, const QDate &end,
+                           const QDate &preferredMonth)
+{
+    d->upToDateGeneration = generation;
+    d->upToDateStart = start;
+    d->upToDateEnd = end;
+    d->upToDatePreferredMonth = preferredMonth;
+}
+
+bool BaseView::isUpToDate(quint64 generation, const QDate &start, const QDate &end,
+                          const QDate &preferredMonth) const
+{
+    return d->upToDateGeneration != 0
+           && d->upToDateGeneration == generation
+           && d->upToDateStart == start
+           && d->upToDateEnd == end
+           && d->upToDatePreferredMonth == preferredMonth;
+}
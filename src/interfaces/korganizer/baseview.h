@@ -138,6 +138,13 @@ public:
      */
     virtual bool supportsZoom();
 
+    /**
+     * returns whether this view observes the calendar and applies added, changed
+     * and deleted incidences itself, so that only other changes make it redraw.
+     * Base implementation returns false.
+     */
+    virtual bool observesCalendar() const;
+
     /**
      * returns whether this view supports date range selection
      * Base implementation returns true.
@@ -367,6 +374,23 @@ public:
     */
     EventViews::EventView::Changes changes() const;
 
+    /**
+       Records that the view shows the dates from @p start to @p end, and
+       @p preferredMonth, as they were at change @p generation of the calendar.
+
+       @see CalendarView::changeGeneration(), CalendarView::settingsGeneration()
+    */
+    void setUpToDate(quint64 generation, const QDate &start, const QDate &end,
+                     const QDate &preferredMonth = QDate());
+
+    /**
+       Returns true if the view already shows the dates from @p start to @p end,
+       and @p preferredMonth, as they are at change @p generation of the calendar,
+       so that showing them again can be skipped.
+    */
+    bool isUpToDate(quint64 generation, const QDate &start, const QDate &end,
+                    const QDate &preferredMonth = QDate()) const;
+
 protected:
     /**
      * reimplement to read view-specific settings
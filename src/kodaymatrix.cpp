@@ -27,6 +27,7 @@
 */
 
 #include "kodaymatrix.h"
+#include "dayinfocache.h"
 #include "koglobals.h"
 #include "prefs/koprefs.h"
 
@@ -72,6 +73,11 @@ KODayMatrix::KODayMatrix(QWidget *parent)
     mHighlightJournals = false;
 }
 
+void KODayMatrix::setDayInfoCache(DayInfoCache *cache)
+{
+    mDayInfoCache = cache;
+}
+
 void KODayMatrix::setCalendar(const Akonadi::ETMCalendar::Ptr &calendar)
 {
     if (mCalendar) {
@@ -231,11 +237,9 @@ void KODayMatrix::updateView(const QDate &actdate)
     // there's no need to update the whole list of incidences... This is just a
     // waste of computational power
     updateIncidences();
-    QMap<QDate, QStringList> holidaysByDate = KOGlobals::self()->holiday(mDays[0],
-                                                                         mDays[NUMDAYS - 1]);
     for (int i = 0; i < NUMDAYS; ++i) {
         //if it is a holy day then draw it red. Sundays are consider holidays, too
-        QStringList holidays = holidaysByDate[mDays[i]];
+        QStringList holidays = mHolidayNames.value(mDays[i]);
         QString holiStr;
 
         if (!holidays.isEmpty()) {
@@ -252,162 +256,28 @@ void KODayMatrix::updateView(const QDate &actdate)
 
 void KODayMatrix::updateIncidences()
 {
-    if (!mCalendar) {
+    if (!mStartDate.isValid()) {
         return;
     }
 
-    mEvents.clear();
-
+    DayInfoCache::Highlights highlights;
     if (mHighlightEvents) {
-        updateEvents();
+        highlights |= DayInfoCache::Events;
     }
-
     if (mHighlightTodos) {
-        updateTodos();
+        highlights |= DayInfoCache::Todos;
     }
-
     if (mHighlightJournals) {
-        updateJournals();
-    }
-
-    mPendingChanges = false;
-}
-
-void KODayMatrix::updateJournals()
-{
-    const KCalCore::Incidence::List incidences = mCalendar->incidences();
-
-    for (const KCalCore::Incidence::Ptr &inc : incidences) {
-        Q_ASSERT(inc);
-        QDate d = inc->dtStart().toLocalTime().date();
-        if (inc->type() == KCalCore::Incidence::TypeJournal
-            && d >= mDays[0]
-            && d <= mDays[NUMDAYS - 1]
-            && !mEvents.contains(d)) {
-            mEvents.append(d);
-        }
-        if (mEvents.count() == NUMDAYS) {
-            // No point in wasting cpu, all days are bold already
-            break;
-        }
-    }
-}
-
-/**
-  * Although updateTodos() is simpler it has some similarities with updateEvent()
-  * but don't bother refactoring them so they share code, there's a bigger fish:
-  * Try to refactor updateTodos(), updateEvent(), updateJournals(), monthview,
-  * agenda view, timeline view, event list view and todo list view
-  * all these 9 places have incidence listing code in common, maybe it could go
-  * to kcal. Ah, and then there's kontact's summary view which still uses
-  * the old CPU consuming code.
-  */
-void KODayMatrix::updateTodos()
-{
-    const KCalCore::Todo::List incidences = mCalendar->todos();
-    QDate d;
-    for (const KCalCore::Todo::Ptr &t : incidences) {
-        if (mEvents.count() == NUMDAYS) {
-            // No point in wasting cpu, all days are bold already
-            break;
-        }
-        Q_ASSERT(t);
-        if (t->hasDueDate()) {
-            ushort recurType = t->recurrenceType();
-
-            if (t->recurs()
-                && !(recurType == KCalCore::Recurrence::rDaily && !KOPrefs::instance()->mDailyRecur)
-                && !(recurType == KCalCore::Recurrence::rWeekly
-                     && !KOPrefs::instance()->mWeeklyRecur)) {
-                // It's a recurring todo, find out in which days it occurs
-                const auto timeDateList
-                    = t->recurrence()->timesInInterval(
-                    QDateTime(mDays[0], {}, Qt::LocalTime),
-                    QDateTime(mDays[NUMDAYS - 1], {}, Qt::LocalTime));
-
-                for (const QDateTime &dt : timeDateList) {
-                    d = dt.toLocalTime().date();
-                    if (!mEvents.contains(d)) {
-                        mEvents.append(d);
-                    }
-                }
-            } else {
-                d = t->dtDue().toLocalTime().date();
-                if (d >= mDays[0] && d <= mDays[NUMDAYS - 1] && !mEvents.contains(d)) {
-                    mEvents.append(d);
-                }
-            }
-        }
+        highlights |= DayInfoCache::Journals;
     }
-}
-
-void KODayMatrix::updateEvents()
-{
-    if (mEvents.count() == NUMDAYS) {
-        mPendingChanges = false;
-        // No point in wasting cpu, all days are bold already
-        return;
-    }
-    const KCalCore::Event::List eventlist = mCalendar->events(mDays[0], mDays[NUMDAYS - 1],
-                                                              mCalendar->timeZone());
-
-    for (const KCalCore::Event::Ptr &event : eventlist) {
-        if (mEvents.count() == NUMDAYS) {
-            // No point in wasting cpu, all days are bold already
-            break;
-        }
 
-        Q_ASSERT(event);
-        const ushort recurType = event->recurrenceType();
-        const QDateTime dtStart = event->dtStart().toLocalTime();
-
-        // timed incidences occur in
-        //   [dtStart(), dtEnd()[. All-day incidences occur in [dtStart(), dtEnd()]
-        // so we subtract 1 second in the timed case
-        const int secsToAdd = event->allDay() ? 0 : -1;
-        const QDateTime dtEnd = event->dtEnd().toLocalTime().addSecs(secsToAdd);
-
-        if (!(recurType == KCalCore::Recurrence::rDaily && !KOPrefs::instance()->mDailyRecur)
-            && !(recurType == KCalCore::Recurrence::rWeekly
-                 && !KOPrefs::instance()->mWeeklyRecur)) {
-            KCalCore::SortableList<QDateTime> timeDateList;
-            const bool isRecurrent = event->recurs();
-            const int eventDuration = dtStart.daysTo(dtEnd);
-
-            if (isRecurrent) {
-                //Its a recurring event, find out in which days it occurs
-                timeDateList = event->recurrence()->timesInInterval(
-                    QDateTime(mDays[0], {}, Qt::LocalTime),
-                    QDateTime(mDays[NUMDAYS - 1], {}, Qt::LocalTime));
-            } else {
-                if (dtStart.date() >= mDays[0]) {
-                    timeDateList.append(dtStart);
-                } else {
-                    // The event starts in another month (not visible))
-                    timeDateList.append(QDateTime(mDays[0], {}, Qt::LocalTime));
-                }
-            }
-
-            for (auto t = timeDateList.begin(); t != timeDateList.end(); ++t) {
-                //This could be a multiday event, so iterate from dtStart() to dtEnd()
-                QDate d = t->toLocalTime().date();
-                int j = 0;
+    const DayInfoCache::DayInfo info
+        = mDayInfoCache ? mDayInfoCache->dayInfo(mDays[0], mDays[NUMDAYS - 1], highlights)
+          : DayInfoCache::compute(mCalendar, mDays[0], mDays[NUMDAYS - 1], highlights);
+    mEvents = info.incidenceDays;
+    mHolidayNames = info.holidays;
+    mWorkDays = info.workDays;
 
-                QDate occurrenceEnd;
-                if (isRecurrent) {
-                    occurrenceEnd = d.addDays(eventDuration);
-                } else {
-                    occurrenceEnd = dtEnd.date();
-                }
-
-                do {
-                    mEvents.append(d);
-                    ++j;
-                    d = d.addDays(1);
-                } while (d <= occurrenceEnd && j < NUMDAYS);
-            }
-        }
-    }
     mPendingChanges = false;
 }
 
@@ -789,7 +659,7 @@ void KODayMatrix::paintEvent(QPaintEvent *)
     p.setPen(actcol);
     QPen tmppen;
 
-    const QList<QDate> workDays = KOGlobals::self()->workDays(mDays[0], mDays[NUMDAYS - 1]);
+    const QList<QDate> &workDays = mWorkDays;
     for (int i = 0; i < NUMDAYS; ++i) {
         row = i / 7;
         column = isRTL ? 6 - (i - row * 7) : i - row * 7;
@@ -34,6 +34,8 @@
 #include <QFrame>
 #include <QDate>
 
+class DayInfoCache;
+
 /**
  *  Replacement for kdpdatebuton.cpp that used 42 widgets for the day
  *  matrix to be displayed. Cornelius thought this was a waste of memory
@@ -93,6 +95,12 @@ public:
     */
     void setCalendar(const Akonadi::ETMCalendar::Ptr &);
 
+    /**
+      Use @p cache for the days with incidences, holidays and work days,
+      instead of computing them for every update.
+    */
+    void setDayInfoCache(DayInfoCache *cache);
+
     /** updates the day matrix to start with the given date. Does all the
      *  necessary checks for holidays or events on a day and stores them
      *  for display later on.
@@ -268,14 +276,6 @@ private:
      */
     QColor getShadedColor(const QColor &color) const;
 
-    /** updates mEvent list with all days that have events */
-    void updateEvents();
-
-    /** updates mEvent list with all days that have to-dos with due date */
-    void updateTodos();
-
-    /** updates mEvent list with all days that have journals */
-    void updateJournals();
 
     /** number of days to be displayed. For now there is no support for any
         other number than 42. so change it at your own risk :o) */
@@ -284,6 +284,9 @@ private:
     /** calendar instance to be queried for holidays, events, ... */
     Akonadi::ETMCalendar::Ptr mCalendar;
 
+    /** cache of the days computed for the matrix, or nullptr */
+    DayInfoCache *mDayInfoCache = nullptr;
+
     /** starting date of the matrix */
     QDate mStartDate;
 
@@ -300,6 +303,12 @@ private:
     /** stores holiday names of the days shown in the matrix. */
     QMap<int, QString> mHolidays;
 
+    /** holiday names by date, as computed for the matrix. */
+    QMap<QDate, QStringList> mHolidayNames;
+
+    /** work days shown in the matrix. */
+    QList<QDate> mWorkDays;
+
     /** index of today or -1 if today is not visible in the matrix. */
     int mToday;
 
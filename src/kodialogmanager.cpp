@@ -204,10 +204,11 @@ void KODialogManager::connectEditor(IncidenceEditorNG::IncidenceDialog *editor)
             SIGNAL(cancelAttendees(Akonadi::Item)));
 }
 
-void KODialogManager::updateSearchDialog()
+void KODialogManager::updateSearchDialog(const Akonadi::Item &item,
+                                         Akonadi::IncidenceChanger::ChangeType changeType)
 {
     if (mSearchDialog) {
-        mSearchDialog->updateView();
+        mSearchDialog->changeIncidenceDisplay(item, changeType);
     }
 }
 
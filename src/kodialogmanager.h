@@ -65,7 +65,8 @@ public:
     // TODO_NG: see if editors-NG have the needed slots.
     void connectEditor(IncidenceEditorNG::IncidenceDialog *editor);
 
-    void updateSearchDialog();
+    void updateSearchDialog(const Akonadi::Item &item,
+                            Akonadi::IncidenceChanger::ChangeType changeType);
 
     void connectTypeAhead(IncidenceEditorNG::IncidenceDialog *editor, KOEventView *view);
 
@@ -51,6 +51,7 @@
 #include <QGridLayout>
 #include <QLabel>
 #include <QVBoxLayout>
+#include <QtConcurrentRun>
 
 ApptSummaryWidget::ApptSummaryWidget(KOrganizerPlugin *plugin, QWidget *parent)
     : KontactInterface::Summary(parent)
@@ -75,6 +76,10 @@ ApptSummaryWidget::ApptSummaryWidget(KOrganizerPlugin *plugin, QWidget *parent)
 
     mChanger = new Akonadi::IncidenceChanger(parent);
 
+    mEventsWatcher = new QFutureWatcher<QVector<SummaryEventInfo> >(this);
+    connect(mEventsWatcher, &QFutureWatcher<QVector<SummaryEventInfo> >::finished,
+            this, &ApptSummaryWidget::slotEventsComputed);
+
     connect(
         mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, this,
         &ApptSummaryWidget::updateView);
@@ -87,6 +92,7 @@ ApptSummaryWidget::ApptSummaryWidget(KOrganizerPlugin *plugin, QWidget *parent)
 
 ApptSummaryWidget::~ApptSummaryWidget()
 {
+    mEventsWatcher->waitForFinished();
 }
 
 void ApptSummaryWidget::configUpdated()
@@ -108,8 +114,39 @@ void ApptSummaryWidget::configUpdated()
 
 void ApptSummaryWidget::updateView()
 {
+    if (mEventsWatcher->isRunning()) {
+        // Computed again once the running computation is done
+        mUpdatePending = true;
+        return;
+    }
+    mUpdatePending = false;
+
+    SummaryEventInfo::setShowSpecialEvents(mShowBirthdaysFromCal,
+                                           mShowAnniversariesFromCal);
+    const QDate start = QDate::currentDate();
+    const QDate end = start.addDays(mDaysAhead - 1);
+
+    // Expanding recurrences and formatting happens in a worker thread, on a
+    // copy of the events, so that we don't block the rest of Kontact.
+    const SummaryEventInfo::Snapshot snapshot
+        = SummaryEventInfo::eventsSnapshot(start, end, mCalendar);
+    mEventsWatcher->setFuture(QtConcurrent::run([start, end, snapshot]() {
+        return SummaryEventInfo::eventInfosForRange(start, end, snapshot);
+    }));
+}
+
+void ApptSummaryWidget::slotEventsComputed()
+{
+    if (mUpdatePending) {
+        updateView();
+        return;
+    }
+
     qDeleteAll(mLabels);
     mLabels.clear();
+    mEventByLabel.clear();
+    // Kept around until the next update, the tooltips are built from them on hover
+    mEvents = mEventsWatcher->result();
 
     // The event print consists of the following fields:
     //  icon:start date:days-to-go:summary:time range
@@ -129,22 +166,14 @@ void ApptSummaryWidget::updateView()
     QPixmap pma = loader.loadIcon(QStringLiteral(
                                       "view-calendar-wedding-anniversary"), KIconLoader::Small);
 
-    QStringList uidList;
-    SummaryEventInfo::setShowSpecialEvents(mShowBirthdaysFromCal,
-                                           mShowAnniversariesFromCal);
-    QDate currentDate = QDate::currentDate();
-
-    SummaryEventInfo::List events = SummaryEventInfo::eventsForRange(currentDate, currentDate.addDays(
-                                                                         mDaysAhead - 1),
-                                                                     mCalendar);
-
     QPalette todayPalette = palette();
     KColorScheme::adjustBackground(todayPalette, KColorScheme::ActiveBackground, QPalette::Window);
     QPalette urgentPalette = palette();
     KColorScheme::adjustBackground(urgentPalette, KColorScheme::NegativeBackground,
                                    QPalette::Window);
 
-    foreach (SummaryEventInfo *event, events) {
+    for (int i = 0, total = mEvents.count(); i < total; ++i) {
+        const SummaryEventInfo *event = &mEvents.at(i);
         // Optionally, show only my Events
         /*      if ( mShowMineOnly &&
                   !KCalCore::CalHelper::isMyCalendarIncidence( mCalendarAdaptor, event->ev ) ) {
@@ -153,20 +182,11 @@ void ApptSummaryWidget::updateView()
             TODO: CalHelper is deprecated, remove this?
         */
 
-        KCalCore::Event::Ptr ev = event->ev;
-        // print the first of the recurring event series only
-        if (ev->recurs()) {
-            if (uidList.contains(ev->instanceIdentifier())) {
-                continue;
-            }
-            uidList.append(ev->instanceIdentifier());
-        }
-
         // Icon label
         label = new QLabel(this);
-        if (ev->categories().contains(QLatin1String("BIRTHDAY"), Qt::CaseInsensitive)) {
+        if (event->categories & SummaryEventInfo::BirthdayCategory) {
             label->setPixmap(pmb);
-        } else if (ev->categories().contains(QLatin1String("ANNIVERSARY"), Qt::CaseInsensitive)) {
+        } else if (event->categories & SummaryEventInfo::AnniversaryCategory) {
             label->setPixmap(pma);
         } else {
             label->setPixmap(pm);
@@ -216,13 +236,12 @@ void ApptSummaryWidget::updateView()
                     &KUrlLabel::leftClickedUrl), this, &ApptSummaryWidget::viewEvent);
         connect(urlLabel, QOverload<const QString &>::of(
                     &KUrlLabel::rightClickedUrl), this, &ApptSummaryWidget::popupMenu);
-        if (!event->summaryTooltip.isEmpty()) {
-            urlLabel->setToolTip(event->summaryTooltip);
-        }
+        mEventByLabel.insert(urlLabel, i);
 
         // Time range label (only for non-floating events)
-        if (!event->timeRange.isEmpty()) {
-            label = new QLabel(event->timeRange, this);
+        const QString timeRange = event->timeRange();
+        if (!timeRange.isEmpty()) {
+            label = new QLabel(timeRange, this);
             label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
             mLayout->addWidget(label, counter, 4);
             mLabels.append(label);
@@ -231,8 +250,6 @@ void ApptSummaryWidget::updateView()
         counter++;
     }
 
-    qDeleteAll(events);
-
     if (!counter) {
         QLabel *noEvents = new QLabel(
             i18np("No upcoming events starting within the next day",
@@ -299,6 +316,12 @@ bool ApptSummaryWidget::eventFilter(QObject *obj, QEvent *e)
         if (e->type() == QEvent::Leave) {
             Q_EMIT message(QString());
         }
+        if (e->type() == QEvent::ToolTip && label->toolTip().isEmpty()) {
+            const int index = mEventByLabel.value(label, -1);
+            if (index >= 0) {
+                label->setToolTip(mEvents.at(index).summaryTooltip(mCalendar));
+            }
+        }
     }
 
     return KontactInterface::Summary::eventFilter(obj, e);
@@ -26,9 +26,13 @@
 #ifndef SUMMARYWIDGET_H
 #define SUMMARYWIDGET_H
 
+#include "summaryeventinfo.h"
+
 #include <KontactInterface/Summary>
 #include <Akonadi/Calendar/ETMCalendar>
 
+#include <QFutureWatcher>
+
 class KOrganizerPlugin;
 
 namespace Akonadi {
@@ -66,6 +70,7 @@ protected:
 
 private Q_SLOTS:
     void updateView();
+    void slotEventsComputed();
     void popupMenu(const QString &uid);
     void viewEvent(const QString &uid);
     void removeEvent(const Akonadi::Item &item);
@@ -78,6 +83,10 @@ private:
 
     QGridLayout *mLayout = nullptr;
     QList<QLabel *> mLabels;
+    QVector<SummaryEventInfo> mEvents;
+    QHash<QObject *, int> mEventByLabel;
+    QFutureWatcher<QVector<SummaryEventInfo> > *mEventsWatcher = nullptr;
+    bool mUpdatePending = false;
     KOrganizerPlugin *mPlugin = nullptr;
     int mDaysAhead;
     bool mShowBirthdaysFromCal = false;
@@ -54,7 +54,7 @@ void SummaryEventTester::test_Multiday()
 
         QCOMPARE(ev4->summaryText,
                  QString(multidayWithTimeInProgress + QString::fromLatin1(" (%1/7)").arg(i + 2)));
-        QCOMPARE(ev4->timeRange, QStringLiteral("%1 - %2").arg(
+        QCOMPARE(ev4->timeRange(), QStringLiteral("%1 - %2").arg(
                      QLocale::system().toString(QTime(0, 0), QLocale::ShortFormat),
                      QLocale::system().toString(QTime(23, 59), QLocale::ShortFormat)));
         //QCOMPARE( ev4->startDate, KLocale::global()->formatDate( QDate( today.addDays( i ) ), KLocale::FancyLongDate ) );
@@ -127,24 +127,24 @@ void SummaryEventTester::test_Multiday()
     QCOMPARE(3, eventsToday.size());
     foreach (const SummaryEventInfo *ev, eventsToday) {
         if (ev->summaryText == multidayWithTimeInProgress + QLatin1String(" (2/7)")) {
-            QCOMPARE(ev->timeRange, QStringLiteral("%1 - %2").arg(
+            QCOMPARE(ev->timeRange(), QStringLiteral("%1 - %2").arg(
                          QLocale::system().toString(QTime(0, 0), QLocale::ShortFormat),
                          QLocale::system().toString(QTime(23, 59), QLocale::ShortFormat)));
             QCOMPARE(ev->startDate, QStringLiteral("Today"));
             QCOMPARE(ev->daysToGo, QStringLiteral("now"));
             QCOMPARE(ev->makeBold, true);
         } else if (ev->summaryText == multiDayAllDayStartingToday) {
-            QVERIFY(ev->timeRange.isEmpty());
+            QVERIFY(ev->timeRange().isEmpty());
             QCOMPARE(ev->startDate, QStringLiteral("Today"));
             QCOMPARE(ev->daysToGo, QStringLiteral("all day"));
             QCOMPARE(ev->makeBold, true);
         } else if (ev->summaryText == multiDayAllDayStartingYesterday) {
-            QVERIFY(ev->timeRange.isEmpty());
+            QVERIFY(ev->timeRange().isEmpty());
             QCOMPARE(ev->startDate, QStringLiteral("Today"));
             QCOMPARE(ev->daysToGo, QStringLiteral("all day"));
             QCOMPARE(ev->makeBold, true);
         } else {
-            qDebug() << "Unexpected " << ev->summaryText << ev->startDate << ev->timeRange
+            qDebug() << "Unexpected " << ev->summaryText << ev->startDate << ev->timeRange()
                      << ev->daysToGo;
             QVERIFY(false);   // unexpected event!
         }
@@ -155,7 +155,7 @@ void SummaryEventTester::test_Multiday()
     QCOMPARE(1, events2.size());
     SummaryEventInfo *ev1 = events2.at(0);
     QCOMPARE(ev1->summaryText, multiDayAllDayInFuture);
-    QVERIFY(ev1->timeRange.isEmpty());
+    QVERIFY(ev1->timeRange().isEmpty());
     QCOMPARE(ev1->startDate, QLocale::system().toString(today.addDays(multiDayFuture)));
     QCOMPARE(ev1->daysToGo, QString::fromLatin1("in %1 days").arg(multiDayFuture));
     QCOMPARE(ev1->makeBold, false);
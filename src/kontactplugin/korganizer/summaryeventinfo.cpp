@@ -37,28 +37,20 @@ using namespace KCalUtils;
 
 #include <KLocalizedString>
 
+#include <QCache>
 #include <QDate>
+#include <QHash>
 #include <QLocale>
+#include <QSet>
 #include <QStringList>
 
 bool SummaryEventInfo::mShowBirthdays = true;
 bool SummaryEventInfo::mShowAnniversaries = true;
 
-typedef QHash<QString, QDateTime> DateTimeByUidHash;
-Q_GLOBAL_STATIC(DateTimeByUidHash, sDateTimeByUid)
-
-static bool eventLessThan(const KCalCore::Event::Ptr &event1, const KCalCore::Event::Ptr &event2)
-{
-    QDateTime kdt1 = sDateTimeByUid()->value(event1->instanceIdentifier());
-    QDateTime kdt2 = sDateTimeByUid()->value(event2->instanceIdentifier());
-    if (kdt1 < kdt2) {
-        return true;
-    } else if (kdt1 > kdt2) {
-        return false;
-    } else {
-        return event1->summary() < event2->summary();
-    }
-}
+// Tooltips are expensive to generate and most are never shown, so we only
+// build them on hover and keep the last few around.
+typedef QCache<QString, QString> ToolTipCache;
+Q_GLOBAL_STATIC_WITH_ARGS(ToolTipCache, sToolTipCache, (64))
 
 void SummaryEventInfo::setShowSpecialEvents(bool showBirthdays, bool showAnniversaries)
 {
@@ -66,17 +58,29 @@ void SummaryEventInfo::setShowSpecialEvents(bool showBirthdays, bool showAnniver
     mShowAnniversaries = showAnniversaries;
 }
 
-bool SummaryEventInfo::skip(const KCalCore::Event::Ptr &event)
+SummaryEventInfo::SpecialCategories SummaryEventInfo::specialCategories(
+    const KCalCore::Event::Ptr &event)
 {
     //simply check categories because the birthdays resource always adds
     //the appropriate category to the event.
-    QStringList c = event->categories();
-    if (!mShowBirthdays
-        && c.contains(QLatin1String("BIRTHDAY"), Qt::CaseInsensitive)) {
+    SpecialCategories categories = NoSpecialCategory;
+    const QStringList c = event->categories();
+    for (const QString &category : c) {
+        if (category.compare(QLatin1String("BIRTHDAY"), Qt::CaseInsensitive) == 0) {
+            categories |= BirthdayCategory;
+        } else if (category.compare(QLatin1String("ANNIVERSARY"), Qt::CaseInsensitive) == 0) {
+            categories |= AnniversaryCategory;
+        }
+    }
+    return categories;
+}
+
+bool SummaryEventInfo::skip(SpecialCategories categories)
+{
+    if (!mShowBirthdays && (categories & BirthdayCategory)) {
         return true;
     }
-    if (!mShowAnniversaries
-        && c.contains(QLatin1String("ANNIVERSARY"), Qt::CaseInsensitive)) {
+    if (!mShowAnniversaries && (categories & AnniversaryCategory)) {
         return true;
     }
 
@@ -93,55 +97,124 @@ SummaryEventInfo::SummaryEventInfo()
 SummaryEventInfo::List SummaryEventInfo::eventsForRange(const QDate &start, const QDate &end,
                                                         const Akonadi::ETMCalendar::Ptr &calendar)
 {
-    KCalCore::Event::List allEvents = calendar->events();
-    KCalCore::Event::List events;
-    const auto currentDateTime = QDateTime::currentDateTime();
-    const QDate currentDate = currentDateTime.date();
+    const QVector<SummaryEventInfo> eventInfos
+        = eventInfosForRange(start, end, eventsSnapshot(start, end, calendar));
+
+    SummaryEventInfo::List eventInfoList;
+    eventInfoList.reserve(eventInfos.count());
+    for (const SummaryEventInfo &eventInfo : eventInfos) {
+        eventInfoList.append(new SummaryEventInfo(eventInfo));
+    }
+    return eventInfoList;
+}
+
+/**static*/
+SummaryEventInfo::Snapshot SummaryEventInfo::eventsSnapshot(const QDate &start, const QDate &end,
+                                                            const Akonadi::ETMCalendar::Ptr &calendar)
+{
+    const KCalCore::Event::List allEvents = calendar->events();
+    Snapshot events;
+    QSet<QString> seriesKeys;
 
-    sDateTimeByUid()->clear();
-    for (int i = 0; i < allEvents.count(); ++i) {
-        KCalCore::Event::Ptr event = allEvents.at(i);
-        if (skip(event)) {
+    for (const KCalCore::Event::Ptr &event : allEvents) {
+        const SpecialCategories categories = specialCategories(event);
+        if (skip(categories)) {
             continue;
         }
 
-        const auto eventStart = event->dtStart().toLocalTime();
-        const auto eventEnd = event->dtEnd().toLocalTime();
+        // Recurrences are expanded by eventInfosForRange(). We only show the
+        // first of a recurring series, so don't even copy the other ones.
+        if (event->recurs()) {
+            // Nor the series which start after the range or ended before it
+            if (event->dtStart().toLocalTime().date() > end) {
+                continue;
+            }
+            const KCalCore::Recurrence *recurrence = event->recurrence();
+            if (recurrence->duration() == 0 && recurrence->endDate() < start) {
+                continue;
+            }
+            const QString key = event->instanceIdentifier();
+            if (seriesKeys.contains(key)) {
+                continue;
+            }
+            seriesKeys.insert(key);
+        } else {
+            const auto eventStart = event->dtStart().toLocalTime();
+            const auto eventEnd = event->dtEnd().toLocalTime();
+            if (!((end >= eventStart.date() && start <= eventEnd.date())
+                  || (start >= eventStart.date() && end <= eventEnd.date()))) {
+                continue;
+            }
+        }
+
+        // The calendar keeps modifying its incidences in place
+        SnapshotEvent snapshotEvent;
+        snapshotEvent.event = KCalCore::Event::Ptr(event->clone());
+        snapshotEvent.categories = categories;
+        events << snapshotEvent;
+    }
+
+    return events;
+}
+
+/**static*/
+QVector<SummaryEventInfo> SummaryEventInfo::eventInfosForRange(const QDate &start, const QDate &end,
+                                                               const Snapshot &snapshot)
+{
+    Snapshot events;
+    QHash<QString, QDateTime> dateTimeByUid;
+    const auto currentDateTime = QDateTime::currentDateTime();
+    const QDate currentDate = currentDateTime.date();
+
+    for (const SnapshotEvent &snapshotEvent : snapshot) {
+        const KCalCore::Event::Ptr &event = snapshotEvent.event;
         if (event->recurs()) {
             const auto occurrences = event->recurrence()->timesInInterval(QDateTime(start,
                                                                                     {}),
                                                                           QDateTime(end, {}));
             if (!occurrences.isEmpty()) {
-                events << event;
-                sDateTimeByUid()->insert(event->instanceIdentifier(), occurrences.first());
+                events << snapshotEvent;
+                dateTimeByUid.insert(event->instanceIdentifier(), occurrences.first());
             }
         } else {
-            if ((end >= eventStart.date() && start <= eventEnd.date())
-                || (start >= eventStart.date() && end <= eventEnd.date())) {
-                events << event;
-                if (eventStart.date() < start) {
-                    sDateTimeByUid()->insert(event->instanceIdentifier(), QDateTime(start));
-                } else {
-                    sDateTimeByUid()->insert(event->instanceIdentifier(), eventStart);
-                }
+            const auto eventStart = event->dtStart().toLocalTime();
+            events << snapshotEvent;
+            if (eventStart.date() < start) {
+                dateTimeByUid.insert(event->instanceIdentifier(), QDateTime(start));
+            } else {
+                dateTimeByUid.insert(event->instanceIdentifier(), eventStart);
             }
         }
     }
 
-    std::sort(events.begin(), events.end(), eventLessThan);
+    std::sort(events.begin(), events.end(),
+              [&dateTimeByUid](const SnapshotEvent &snapshotEvent1,
+                               const SnapshotEvent &snapshotEvent2) {
+        const KCalCore::Event::Ptr &event1 = snapshotEvent1.event;
+        const KCalCore::Event::Ptr &event2 = snapshotEvent2.event;
+        const QDateTime kdt1 = dateTimeByUid.value(event1->instanceIdentifier());
+        const QDateTime kdt2 = dateTimeByUid.value(event2->instanceIdentifier());
+        if (kdt1 < kdt2) {
+            return true;
+        } else if (kdt1 > kdt2) {
+            return false;
+        } else {
+            return event1->summary() < event2->summary();
+        }
+    });
 
-    SummaryEventInfo::List eventInfoList;
+    QVector<SummaryEventInfo> eventInfoList;
     KCalCore::Event::Ptr ev;
     eventInfoList.reserve(events.count());
     auto itEnd = events.constEnd();
     for (auto it = events.constBegin(); it != itEnd; ++it) {
-        ev = *it;
+        ev = it->event;
         // Count number of days remaining in multiday event
         int span = 1;
         int dayof = 1;
         const auto eventStart = ev->dtStart().toLocalTime();
         const auto eventEnd = ev->dtEnd().toLocalTime();
-        const QDate occurrenceStartDate = sDateTimeByUid()->value(ev->instanceIdentifier()).date();
+        const QDate occurrenceStartDate = dateTimeByUid.value(ev->instanceIdentifier()).date();
 
         QDate startOfMultiday = eventStart.date();
         if (startOfMultiday < currentDate) {
@@ -149,18 +222,18 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(const QDate &start, cons
         }
         bool firstDayOfMultiday = (start == startOfMultiday);
 
-        SummaryEventInfo *summaryEvent = new SummaryEventInfo();
-        eventInfoList.append(summaryEvent);
+        SummaryEventInfo summaryEvent;
 
         // Event
-        summaryEvent->ev = ev;
+        summaryEvent.ev = ev;
+        summaryEvent.categories = it->categories;
 
         // Start date label
         QString str;
         QDate sD = occurrenceStartDate;
         if (currentDate >= sD) {
             str = i18nc("the appointment is today", "Today");
-            summaryEvent->makeBold = true;
+            summaryEvent.makeBold = true;
         } else if (sD == currentDate.addDays(1)) {
             str = i18nc("the appointment is tomorrow", "Tomorrow");
         } else {
@@ -175,7 +248,7 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(const QDate &start, cons
                 str = locale.toString(sD, QLocale::LongFormat);
             }
         }
-        summaryEvent->startDate = str;
+        summaryEvent.startDate = str;
 
         if (ev->isMultiDay()) {
             dayof = eventStart.date().daysTo(start) + 1;
@@ -189,7 +262,7 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(const QDate &start, cons
                   +QLatin1String(" -\n ")
                   +IncidenceFormatter::dateToString(ev->dtEnd().toLocalTime().date(), false);
         }
-        summaryEvent->dateSpan = str;
+        summaryEvent.dateSpan = str;
 
         // Days to go label
         str.clear();
@@ -222,7 +295,7 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(const QDate &start, cons
                                       "1 min", "%1 mins", mins);
                         if (hours < 1) {
                             // happens in less than 1 hour
-                            summaryEvent->makeUrgent = true;
+                            summaryEvent.makeUrgent = true;
                         }
                     }
                 } else {
@@ -232,63 +305,87 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(const QDate &start, cons
                 str = i18n("all day");
             }
         }
-        summaryEvent->daysToGo = str;
+        summaryEvent.daysToGo = str;
 
         // Summary label
         str = ev->richSummary();
         if (ev->isMultiDay() && !ev->allDay()) {
             str.append(QStringLiteral(" (%1/%2)").arg(dayof).arg(span));
         }
-        summaryEvent->summaryText = str;
-        summaryEvent->summaryUrl = ev->uid();
-
-        QString displayName;
-        Akonadi::Item item = calendar->item(ev);
-        if (item.isValid()) {
-            const Akonadi::Collection col = item.parentCollection();
-            if (col.isValid()) {
-                displayName = col.displayName();
-            }
-        }
-        summaryEvent->summaryTooltip = KCalUtils::IncidenceFormatter::toolTipStr(displayName, ev,
-                                                                                 start, true);
+        summaryEvent.summaryText = str;
+        summaryEvent.summaryUrl = ev->uid();
 
-        // Time range label (only for non-floating events)
-        str.clear();
-        if (!ev->allDay()) {
-            QTime sST = eventStart.time();
-            QTime sET = eventEnd.time();
-            if (ev->isMultiDay()) {
-                if (eventStart.date() < start) {
-                    sST = QTime(0, 0);
-                }
-                if (eventEnd.date() > end) {
-                    sET = QTime(23, 59);
-                }
+        summaryEvent.mRangeStart = start;
+        summaryEvent.mRangeEnd = end;
+
+        eventInfoList.append(summaryEvent);
+    }
+
+    return eventInfoList;
+}
+
+QString SummaryEventInfo::timeRange() const
+{
+    // Time range label (only for non-floating events)
+    QString str;
+    if (!ev->allDay()) {
+        const auto eventStart = ev->dtStart().toLocalTime();
+        const auto eventEnd = ev->dtEnd().toLocalTime();
+        QTime sST = eventStart.time();
+        QTime sET = eventEnd.time();
+        if (ev->isMultiDay()) {
+            if (eventStart.date() < mRangeStart) {
+                sST = QTime(0, 0);
+            }
+            if (eventEnd.date() > mRangeEnd) {
+                sET = QTime(23, 59);
             }
-            str = i18nc("Time from - to", "%1 - %2",
-                        QLocale::system().toString(sST, QLocale::ShortFormat),
-                        QLocale::system().toString(sET, QLocale::ShortFormat));
-            summaryEvent->timeRange = str;
         }
+        str = i18nc("Time from - to", "%1 - %2",
+                    QLocale::system().toString(sST, QLocale::ShortFormat),
+                    QLocale::system().toString(sET, QLocale::ShortFormat));
+    }
 
-        // For recurring events, append the next occurrence to the time range label
-        if (ev->recurs()) {
-            QDateTime kdt(start, QTime(0, 0, 0));
-            kdt = kdt.addSecs(-1);
-            QDateTime next = ev->recurrence()->getNextDateTime(kdt);
-            QString tmp = IncidenceFormatter::dateTimeToString(
-                ev->recurrence()->getNextDateTime(next), ev->allDay(), true);
-            if (!summaryEvent->timeRange.isEmpty()) {
-                summaryEvent->timeRange += QLatin1String("<br>");
-            }
-            summaryEvent->timeRange += QLatin1String("<font size=\"small\"><i>")
-                                       +i18nc("next occurrence", "Next: %1", tmp)
-                                       +QLatin1String("</i></font>");
+    // For recurring events, append the next occurrence to the time range label
+    if (ev->recurs()) {
+        QDateTime kdt(mRangeStart, QTime(0, 0, 0));
+        kdt = kdt.addSecs(-1);
+        QDateTime next = ev->recurrence()->getNextDateTime(kdt);
+        QString tmp = IncidenceFormatter::dateTimeToString(
+            ev->recurrence()->getNextDateTime(next), ev->allDay(), true);
+        if (!str.isEmpty()) {
+            str += QLatin1String("<br>");
         }
+        str += QLatin1String("<font size=\"small\"><i>")
+               +i18nc("next occurrence", "Next: %1", tmp)
+               +QLatin1String("</i></font>");
     }
 
-    return eventInfoList;
+    return str;
+}
+
+QString SummaryEventInfo::summaryTooltip(const Akonadi::ETMCalendar::Ptr &calendar) const
+{
+    const QString key = ev->instanceIdentifier()
+                        + QLatin1Char('/') + QString::number(ev->revision())
+                        + QLatin1Char('/') + ev->lastModified().toString(Qt::ISODate)
+                        + QLatin1Char('/') + mRangeStart.toString(Qt::ISODate);
+    if (const QString *cached = sToolTipCache()->object(key)) {
+        return *cached;
+    }
+
+    QString displayName;
+    Akonadi::Item item = calendar->item(ev);
+    if (item.isValid()) {
+        const Akonadi::Collection col = item.parentCollection();
+        if (col.isValid()) {
+            displayName = col.displayName();
+        }
+    }
+    const QString toolTip = KCalUtils::IncidenceFormatter::toolTipStr(displayName, ev,
+                                                                      mRangeStart, true);
+    sToolTipCache()->insert(key, new QString(toolTip));
+    return toolTip;
 }
 
 SummaryEventInfo::List SummaryEventInfo::eventsForDate(const QDate &date,
@@ -28,7 +28,8 @@
 
 #include <Akonadi/Calendar/ETMCalendar>
 
-class QDate;
+#include <QDate>
+#include <QVector>
 
 class SummaryEventInfo
 {
@@ -36,27 +37,76 @@ public:
 
     typedef QList<SummaryEventInfo *> List;
 
+    enum SpecialCategory {
+        NoSpecialCategory = 0x0,
+        BirthdayCategory = 0x1,
+        AnniversaryCategory = 0x2
+    };
+    Q_DECLARE_FLAGS(SpecialCategories, SpecialCategory)
+
+    /**
+     * An event copied for eventInfosForRange(), with its special categories
+     * classified while copying.
+     */
+    struct SnapshotEvent {
+        KCalCore::Event::Ptr event;
+        SpecialCategories categories;
+    };
+    typedef QVector<SnapshotEvent> Snapshot;
+
     SummaryEventInfo();
 
     static List eventsForDate(const QDate &date, const Akonadi::ETMCalendar::Ptr &calendar);
     static List eventsForRange(const QDate &start, const QDate &end, // range is inclusive
                                const Akonadi::ETMCalendar::Ptr &calendar);
+
+    /**
+     * Returns copies of the events which may occur in the range, for use by
+     * eventInfosForRange() outside of the GUI thread.
+     */
+    static Snapshot eventsSnapshot(const QDate &start, const QDate &end,
+                                   const Akonadi::ETMCalendar::Ptr &calendar);
+
+    /**
+     * Computes the summary of the events of @p snapshot occurring in the range.
+     * Does not touch the calendar, so it can be run in a worker thread.
+     */
+    static QVector<SummaryEventInfo> eventInfosForRange(const QDate &start, const QDate &end,
+                                                        const Snapshot &snapshot);
     static void setShowSpecialEvents(bool skipBirthdays, bool skipAnniversaries);
 
+    /**
+     * The time range label, including the next occurrence of recurring events.
+     * Built on demand, as it is only needed for the rows which are shown.
+     */
+    QString timeRange() const;
+
+    /**
+     * The tooltip of the summary label. Built on demand, when it is about to be
+     * shown, and kept in a small cache shared by all summary events.
+     */
+    QString summaryTooltip(const Akonadi::ETMCalendar::Ptr &calendar) const;
+
     KCalCore::Event::Ptr ev;
+    SpecialCategories categories;
     QString startDate;
     QString dateSpan;
     QString daysToGo;
-    QString timeRange;
     QString summaryText;
     QString summaryUrl;
-    QString summaryTooltip;
     bool makeBold;
     bool makeUrgent;
 
 private:
-    static bool skip(const KCalCore::Event::Ptr &event);
+    static SpecialCategories specialCategories(const KCalCore::Event::Ptr &event);
+    static bool skip(SpecialCategories categories);
     static bool mShowBirthdays, mShowAnniversaries;
+
+    // the range the event was looked up for
+    QDate mRangeStart;
+    QDate mRangeEnd;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(SummaryEventInfo::SpecialCategories)
+
 #endif
@@ -49,6 +49,7 @@
 #include <QLabel>
 #include <QTextDocument>  // for Qt::mightBeRichText
 #include <QVBoxLayout>
+#include <QtConcurrentRun>
 
 using namespace KCalUtils;
 
@@ -71,6 +72,10 @@ TodoSummaryWidget::TodoSummaryWidget(TodoPlugin *plugin, QWidget *parent)
 
     mChanger = new Akonadi::IncidenceChanger(parent);
 
+    mTodosWatcher = new QFutureWatcher<KCalCore::Todo::List>(this);
+    connect(mTodosWatcher, &QFutureWatcher<KCalCore::Todo::List>::finished,
+            this, &TodoSummaryWidget::slotTodosComputed);
+
     connect(
         mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, this,
         &TodoSummaryWidget::updateView);
@@ -82,16 +87,21 @@ TodoSummaryWidget::TodoSummaryWidget(TodoPlugin *plugin, QWidget *parent)
 
 TodoSummaryWidget::~TodoSummaryWidget()
 {
+    mTodosWatcher->waitForFinished();
 }
 
 void TodoSummaryWidget::updateView()
 {
-    qDeleteAll(mLabels);
-    mLabels.clear();
+    if (mTodosWatcher->isRunning()) {
+        // Computed again once the running computation is done
+        mUpdatePending = true;
+        return;
+    }
+    mUpdatePending = false;
 
     KConfig config(QStringLiteral("kcmtodosummaryrc"));
     KConfigGroup group = config.group("Days");
-    int mDaysToGo = group.readEntry("DaysToShow", 7);
+    mDaysToGo = group.readEntry("DaysToShow", 7);
 
     group = config.group("Hide");
     mHideInProgress = group.readEntry("InProgress", false);
@@ -115,9 +125,11 @@ void TodoSummaryWidget::updateView()
     //    days to go before to-do is due
     //    which types of to-dos to hide
 
-    KCalCore::Todo::List prList;
-
+    // The filter only reads a few fields, so it runs here and only the to-dos
+    // passing it are copied for the worker thread, which does the sorting
+    // without blocking the rest of Kontact.
     const QDate currDate = QDate::currentDate();
+    KCalCore::Todo::List snapshot;
     const KCalCore::Todo::List todos = mCalendar->todos();
     for (const KCalCore::Todo::Ptr &todo : todos) {
         if (todo->hasDueDate()) {
@@ -143,20 +155,39 @@ void TodoSummaryWidget::updateView()
             continue;
         }
 
-        prList.append(todo);
+        snapshot.append(KCalCore::Todo::Ptr(todo->clone()));
     }
-    if (!prList.isEmpty()) {
-        prList = Akonadi::ETMCalendar::sortTodos(prList,
-                                                 KCalCore::TodoSortSummary,
-                                                 KCalCore::SortDirectionAscending);
-        prList = Akonadi::ETMCalendar::sortTodos(prList,
-                                                 KCalCore::TodoSortPriority,
-                                                 KCalCore::SortDirectionAscending);
-        prList = Akonadi::ETMCalendar::sortTodos(prList,
-                                                 KCalCore::TodoSortDueDate,
-                                                 KCalCore::SortDirectionAscending);
+
+    mTodosWatcher->setFuture(QtConcurrent::run([snapshot]() {
+        KCalCore::Todo::List prList = snapshot;
+        if (!prList.isEmpty()) {
+            prList = Akonadi::ETMCalendar::sortTodos(prList,
+                                                     KCalCore::TodoSortSummary,
+                                                     KCalCore::SortDirectionAscending);
+            prList = Akonadi::ETMCalendar::sortTodos(prList,
+                                                     KCalCore::TodoSortPriority,
+                                                     KCalCore::SortDirectionAscending);
+            prList = Akonadi::ETMCalendar::sortTodos(prList,
+                                                     KCalCore::TodoSortDueDate,
+                                                     KCalCore::SortDirectionAscending);
+        }
+        return prList;
+    }));
+}
+
+void TodoSummaryWidget::slotTodosComputed()
+{
+    if (mUpdatePending) {
+        updateView();
+        return;
     }
 
+    qDeleteAll(mLabels);
+    mLabels.clear();
+
+    const KCalCore::Todo::List prList = mTodosWatcher->result();
+    const QDate currDate = QDate::currentDate();
+
     // The to-do print consists of the following fields:
     //  icon:due date:days-to-go:priority:summary:status
     // where,
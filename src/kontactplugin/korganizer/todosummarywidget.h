@@ -33,6 +33,8 @@
 #include <KontactInterface/Summary>
 #include <Akonadi/Calendar/ETMCalendar>
 
+#include <QFutureWatcher>
+
 class TodoPlugin;
 
 namespace Akonadi {
@@ -69,6 +71,7 @@ protected:
 
 private Q_SLOTS:
     void updateView();
+    void slotTodosComputed();
     void popupMenu(const QString &uid);
     void viewTodo(const QString &uid);
     void removeTodo(const Akonadi::Item &item);
@@ -78,7 +81,7 @@ private:
     TodoPlugin *mPlugin = nullptr;
     QGridLayout *mLayout = nullptr;
 
-    bool mDaysToGo = false;
+    int mDaysToGo = 7;
     bool mHideInProgress = false;
     bool mHideOverdue = false;
     bool mHideCompleted = false;
@@ -89,6 +92,8 @@ private:
     QList<QLabel *> mLabels;
     Akonadi::ETMCalendar::Ptr mCalendar;
     Akonadi::IncidenceChanger *mChanger = nullptr;
+    QFutureWatcher<KCalCore::Todo::List> *mTodosWatcher = nullptr;
+    bool mUpdatePending = false;
 
     /**
       Test if the To-do starts today.
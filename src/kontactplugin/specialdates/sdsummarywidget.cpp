@@ -32,6 +32,7 @@
 #include <CalendarSupport/CalendarSingleton>
 #include <AkonadiCore/ItemFetchJob>
 #include <AkonadiCore/ItemFetchScope>
+#include <AkonadiCore/Monitor>
 #include <AkonadiCore/SearchQuery>
 #include <AkonadiCore/EntityDisplayAttribute>
 #include <Akonadi/Contact/ContactSearchJob>
@@ -48,8 +49,14 @@
 #include <QDesktopServices>
 #include <KHolidays/HolidayRegion>
 
+#include <KCalCore/Recurrence>
+
 #include <QDate>
 #include <QEvent>
+#include <QHash>
+#include <QSet>
+#include <QTimeZone>
+#include <QtConcurrentRun>
 #include <QLabel>
 #include <QGridLayout>
 
@@ -65,7 +72,9 @@ public:
 BirthdaySearchJob::BirthdaySearchJob(QObject *parent, int daysInAdvance)
     : ItemSearchJob(parent)
 {
-    fetchScope().fetchFullPayload();
+    // Only ids and revisions, the payload of contacts we did not see yet is
+    // fetched separately.
+    fetchScope().fetchFullPayload(false);
     setMimeTypes({KContacts::Addressee::mimeType()});
 
     Akonadi::SearchQuery query;
@@ -111,10 +120,23 @@ public:
     }
 };
 
+class SDCalendarSnapshot
+{
+public:
+    KCalCore::Event::List events; // copies, safe to use in the worker thread
+    QHash<QString, QSet<QDateTime> > exceptions; // recurrence ids, by uid
+    QString holidayRegion;
+    QTimeZone timeZone;
+    int daysAhead = 0;
+    bool showBirthdays = false;
+    bool showAnniversaries = false;
+    bool showHolidays = false;
+    bool showSpecials = false;
+};
+
 SDSummaryWidget::SDSummaryWidget(KontactInterface::Plugin *plugin, QWidget *parent)
     : KontactInterface::Summary(parent)
     , mPlugin(plugin)
-    , mHolidays(nullptr)
 {
     mCalendar = CalendarSupport::calendarSingleton();
     // Create the Summary Layout
@@ -149,13 +171,28 @@ SDSummaryWidget::SDSummaryWidget(KontactInterface::Plugin *plugin, QWidget *pare
     connect(mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged,
             this, &SDSummaryWidget::updateView);
 
+    mCalendarWatcher = new QFutureWatcher<QList<SDEntry> >(this);
+    connect(mCalendarWatcher, &QFutureWatcher<QList<SDEntry> >::finished,
+            this, &SDSummaryWidget::slotCalendarScanFinished);
+
+    mContactMonitor = new Akonadi::Monitor(this);
+    mContactMonitor->setObjectName(QStringLiteral("SDSummaryWidgetContactMonitor"));
+    mContactMonitor->setMimeTypeMonitored(KContacts::Addressee::mimeType());
+    mContactMonitor->itemFetchScope().fetchFullPayload();
+    connect(mContactMonitor, &Akonadi::Monitor::itemAdded,
+            this, &SDSummaryWidget::slotContactChanged);
+    connect(mContactMonitor, &Akonadi::Monitor::itemChanged,
+            this, &SDSummaryWidget::slotContactChanged);
+    connect(mContactMonitor, &Akonadi::Monitor::itemRemoved,
+            this, &SDSummaryWidget::slotContactRemoved);
+
     // Update Configuration
     configUpdated();
 }
 
 SDSummaryWidget::~SDSummaryWidget()
 {
-    delete mHolidays;
+    mCalendarWatcher->waitForFinished();
 }
 
 void SDSummaryWidget::configUpdated()
@@ -182,237 +219,374 @@ void SDSummaryWidget::configUpdated()
     updateView();
 }
 
-bool SDSummaryWidget::initHolidays()
+QString SDSummaryWidget::holidayRegion() const
 {
     KConfig _hconfig(QStringLiteral("korganizerrc"));
     KConfigGroup hconfig(&_hconfig, "Time & Date");
-    QString location = hconfig.readEntry("Holidays");
-    if (!location.isEmpty()) {
-        delete mHolidays;
-        mHolidays = new HolidayRegion(location);
-        return true;
-    }
-    return false;
+    return hconfig.readEntry("Holidays");
 }
 
-// number of days remaining in an Event
-int SDSummaryWidget::span(const KCalCore::Event::Ptr &event) const
+// Map the case-folded category names we are interested in to our categories,
+// so that classifying an event does not need any string conversion.
+typedef QHash<QString, SDCategory> CategoryHash;
+Q_GLOBAL_STATIC_WITH_ARGS(CategoryHash, sCategoryByName, ({
+    { QStringLiteral("birthday"), CategoryBirthday },
+    { QStringLiteral("anniversary"), CategoryAnniversary },
+    { QStringLiteral("holiday"), CategoryHoliday },
+    { QStringLiteral("special occasion"), CategoryOther }
+}))
+
+static bool categoryFromName(const QString &name, SDCategory &category)
 {
-    int span = 1;
-    if (event->isMultiDay() && event->allDay()) {
-        QDate d = event->dtStart().date();
-        if (d < QDate::currentDate()) {
-            d = QDate::currentDate();
-        }
-        while (d < event->dtEnd().date()) {
-            span++;
-            d = d.addDays(1);
-        }
+    const auto it = sCategoryByName->constFind(name.toCaseFolded());
+    if (it == sCategoryByName->constEnd()) {
+        return false;
     }
-    return span;
+    category = it.value();
+    return true;
 }
 
-// day of a multiday Event
-int SDSummaryWidget::dayof(const KCalCore::Event::Ptr &event, const QDate &date) const
+void SDSummaryWidget::slotBirthdayJobFinished(KJob *job)
 {
-    int dayof = 1;
-    QDate d = event->dtStart().date();
-    if (d < QDate::currentDate()) {
-        d = QDate::currentDate();
+    if (job->error()) {
+        qCWarning(KORGANIZER_KONTACTPLUGINS_SPECIALDATES_LOG) << job->errorString();
+        mJobRunning = false;
+        appendContactBirthdays();
+        startCalendarScan();
+        return;
     }
-    while (d < event->dtEnd().date()) {
-        if (d < date) {
-            dayof++;
+
+    // Reuse the contacts we already know in this revision, and only fetch
+    // the payload of the others.
+    QHash<Akonadi::Item::Id, Akonadi::Item> contacts;
+    Akonadi::Item::List outdated;
+    const Akonadi::Item::List items = qobject_cast<BirthdaySearchJob *>(job)->items();
+    for (const Akonadi::Item &item : items) {
+        const auto it = mBirthdayContacts.constFind(item.id());
+        if (it != mBirthdayContacts.constEnd() && it->revision() == item.revision()) {
+            contacts.insert(item.id(), it.value());
+        } else {
+            outdated.append(item);
         }
-        d = d.addDays(1);
     }
-    return dayof;
+    mBirthdayContacts = contacts;
+
+    if (outdated.isEmpty()) {
+        birthdayContactsUpdated();
+        return;
+    }
+
+    Akonadi::ItemFetchJob *fetchJob = new Akonadi::ItemFetchJob(outdated, this);
+    fetchJob->fetchScope().fetchFullPayload();
+    connect(fetchJob, &Akonadi::ItemFetchJob::result,
+            this, &SDSummaryWidget::slotBirthdayContactsFetched);
 }
 
-void SDSummaryWidget::slotBirthdayJobFinished(KJob *job)
+void SDSummaryWidget::slotBirthdayContactsFetched(KJob *job)
 {
-    // ;)
-    BirthdaySearchJob *bJob = qobject_cast<BirthdaySearchJob *>(job);
-    if (bJob) {
-        foreach (const Akonadi::Item &item, bJob->items()) {
-            if (item.hasPayload<KContacts::Addressee>()) {
-                const KContacts::Addressee addressee = item.payload<KContacts::Addressee>();
-                const QDate birthday = addressee.birthday().date();
-                if (birthday.isValid()) {
-                    SDEntry entry;
-                    entry.type = IncidenceTypeContact;
-                    entry.category = CategoryBirthday;
-                    dateDiff(birthday, entry.daysTo, entry.yearsOld);
-                    if (entry.daysTo < mDaysAhead) {
-                        // We need to check the days ahead here because we don't
-                        // filter out Contact Birthdays by mDaysAhead in createLabels().
-                        entry.date = birthday;
-                        entry.addressee = addressee;
-                        entry.item = item;
-                        entry.span = 1;
-                        mDates.append(entry);
-                    }
-                }
-            }
+    if (job->error()) {
+        qCWarning(KORGANIZER_KONTACTPLUGINS_SPECIALDATES_LOG) << job->errorString();
+        // Show what we have, the next update will search again.
+        mJobRunning = false;
+        appendContactBirthdays();
+        startCalendarScan();
+        return;
+    }
+
+    const Akonadi::Item::List items = qobject_cast<Akonadi::ItemFetchJob *>(job)->items();
+    for (const Akonadi::Item &item : items) {
+        if (item.hasPayload<KContacts::Addressee>()) {
+            mBirthdayContacts.insert(item.id(), item);
         }
-        // Carry on.
-        createLabels();
     }
+    birthdayContactsUpdated();
+}
 
+void SDSummaryWidget::birthdayContactsUpdated()
+{
+    mBirthdayContactsDate = QDate::currentDate();
+    mBirthdayContactsDaysAhead = mDaysAhead;
     mJobRunning = false;
+
+    // Carry on.
+    updateView();
 }
 
-void SDSummaryWidget::createLabels()
+void SDSummaryWidget::slotContactChanged(const Akonadi::Item &item)
 {
-    QLabel *label = nullptr;
+    if (item.hasPayload<KContacts::Addressee>()
+        && item.payload<KContacts::Addressee>().birthday().date().isValid()) {
+        mBirthdayContacts.insert(item.id(), item);
+    } else {
+        mBirthdayContacts.remove(item.id());
+    }
+    if (mShowBirthdaysFromKAB) {
+        updateView();
+    }
+}
 
-    // Remove all special date labels from the layout and delete them, as we
-    // will re-create all labels below.
-    setUpdatesEnabled(false);
-    foreach (label, mLabels) {
-        mLayout->removeWidget(label);
-        delete(label);
-        update();
+void SDSummaryWidget::slotContactRemoved(const Akonadi::Item &item)
+{
+    if (mBirthdayContacts.remove(item.id()) && mShowBirthdaysFromKAB) {
+        updateView();
     }
-    mLabels.clear();
+}
 
-    QDate dt;
-    for (dt = QDate::currentDate();
-         dt <= QDate::currentDate().addDays(mDaysAhead - 1);
-         dt = dt.addDays(1)) {
-        const KCalCore::Event::List events = mCalendar->events(dt, mCalendar->timeZone(),
-                                                               KCalCore::EventSortStartDate,
-                                                               KCalCore::SortDirectionAscending);
-        for (const KCalCore::Event::Ptr &ev : events) {
-            // Optionally, show only my Events
-            /* if ( mShowMineOnly &&
-                    !KCalCore::CalHelper::isMyCalendarIncidence( mCalendarAdaptor, ev. ) ) {
-              // FIXME; does isMyCalendarIncidence work !? It's deprecated too.
-              continue;
-              }
-              // TODO: CalHelper is deprecated, remove this?
-              */
-
-            if (ev->customProperty("KABC", "BIRTHDAY") == QLatin1String("YES")) {
-                // Skipping, because these are got by the BirthdaySearchJob
-                // See comments in updateView()
-                continue;
+void SDSummaryWidget::appendContactBirthdays()
+{
+    for (const Akonadi::Item &item : qAsConst(mBirthdayContacts)) {
+        const KContacts::Addressee addressee = item.payload<KContacts::Addressee>();
+        const QDate birthday = addressee.birthday().date();
+        if (birthday.isValid()) {
+            SDEntry entry;
+            entry.type = IncidenceTypeContact;
+            entry.category = CategoryBirthday;
+            dateDiff(birthday, entry.daysTo, entry.yearsOld);
+            if (entry.daysTo < mDaysAhead) {
+                // We need to check the days ahead here because we don't
+                // filter out Contact Birthdays by mDaysAhead in createLabels().
+                entry.date = birthday;
+                entry.addressee = addressee;
+                entry.item = item;
+                entry.span = 1;
+                mDates.append(entry);
             }
+        }
+    }
+}
 
-            if (!ev->categoriesStr().isEmpty()) {
-                QStringList::ConstIterator it2;
-                const QStringList c = ev->categories();
-                QStringList::ConstIterator end(c.constEnd());
-                for (it2 = c.constBegin(); it2 != end; ++it2) {
-                    const QString itUpper((*it2).toUpper());
-                    // Append Birthday Event?
-                    if (mShowBirthdaysFromCal && (itUpper == QLatin1String("BIRTHDAY"))) {
-                        SDEntry entry;
-                        entry.type = IncidenceTypeEvent;
-                        entry.category = CategoryBirthday;
-                        entry.date = dt;
-                        entry.summary = ev->summary();
-                        entry.desc = ev->description();
-                        dateDiff(ev->dtStart().date(), entry.daysTo, entry.yearsOld);
-                        entry.span = 1;
-
-                        /* The following check is to prevent duplicate entries,
-                         * so in case of having a KCal incidence with category birthday
-                         * with summary and date equal to some KABC Atendee we don't show it
-                         * FIXME: port to akonadi, it's kresource based
-                         * */
-                        if (/*!check( bdayRes, dt, ev->summary() )*/ true) {
-                            mDates.append(entry);
-                        }
-                        break;
-                    }
+QList<SDEntry> SDSummaryWidget::calendarEntries(const SDCalendarSnapshot &snapshot)
+{
+    QList<SDEntry> dates;
+    const QDate today = QDate::currentDate();
+    const QDate lastDay = today.addDays(snapshot.daysAhead - 1);
+    const QTimeZone timeZone = snapshot.timeZone;
+
+    // Entries are collected per day, so the whole window is handled with a
+    // single calendar query and a single holiday query.
+    QVector<QList<SDEntry> > entriesByDay(qMax(snapshot.daysAhead, 0));
+    auto appendEntry = [&](const SDEntry &entry) {
+        entriesByDay[today.daysTo(entry.date)].append(entry);
+    };
+    auto isShownFromCalendar = [&snapshot](SDCategory category) {
+        switch (category) {
+        case CategoryBirthday:
+            return snapshot.showBirthdays;
+        case CategoryAnniversary:
+            return snapshot.showAnniversaries;
+        case CategoryHoliday:
+            return snapshot.showHolidays;
+        default:
+            return snapshot.showSpecials;
+        }
+    };
+
+    for (const KCalCore::Event::Ptr &ev : snapshot.events) {
+        // Optionally, show only my Events
+        /* if ( mShowMineOnly &&
+                !KCalCore::CalHelper::isMyCalendarIncidence( mCalendarAdaptor, ev. ) ) {
+          // FIXME; does isMyCalendarIncidence work !? It's deprecated too.
+          continue;
+          }
+          // TODO: CalHelper is deprecated, remove this?
+          */
+
+        if (ev->customProperty("KABC", "BIRTHDAY") == QLatin1String("YES")) {
+            // Skipping, because these are got by the BirthdaySearchJob
+            // See comments in updateView()
+            continue;
+        }
 
-                    // Append Anniversary Event?
-                    if (mShowAnniversariesFromCal && (itUpper == QStringLiteral("ANNIVERSARY"))) {
-                        SDEntry entry;
-                        entry.type = IncidenceTypeEvent;
-                        entry.category = CategoryAnniversary;
-                        entry.date = dt;
-                        entry.summary = ev->summary();
-                        entry.desc = ev->description();
-                        dateDiff(ev->dtStart().date(), entry.daysTo, entry.yearsOld);
-                        entry.span = 1;
-                        if (/*!check( annvRes, dt, ev->summary() )*/ true) {
-                            mDates.append(entry);
-                        }
-                        break;
-                    }
+        // The first category we show wins
+        SDCategory category = CategoryOther;
+        bool found = false;
+        const QStringList categories = ev->categories();
+        for (const QString &name : categories) {
+            if (categoryFromName(name, category) && isShownFromCalendar(category)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            continue;
+        }
 
-                    // Append Holiday Event?
-                    if (mShowHolidays && (itUpper == QLatin1String("HOLIDAY"))) {
-                        SDEntry entry;
-                        entry.type = IncidenceTypeEvent;
-                        entry.category = CategoryHoliday;
-                        entry.date = dt;
-                        entry.summary = ev->summary();
-                        entry.desc = ev->description();
-                        dateDiff(dt, entry.daysTo, entry.yearsOld);
-                        entry.yearsOld = -1; //ignore age of holidays
-                        entry.span = span(ev);
-                        if (entry.span > 1 && dayof(ev, dt) > 1) {     // skip days 2,3,...
-                            break;
-                        }
-                        mDates.append(entry);
-                        break;
-                    }
+        const QDate evStart = ev->allDay() ? ev->dtStart().date()
+                              : ev->dtStart().toTimeZone(timeZone).date();
+        const QDate evEnd = ev->allDay() ? ev->dtEnd().date()
+                            : ev->dtEnd().toTimeZone(timeZone).date();
+        const int extraDays = ev->isMultiDay(timeZone) ? evStart.daysTo(evEnd) : 0;
+
+        // Dates on which an occurrence of the event starts; we look back far
+        // enough to catch multiday occurrences which started before today.
+        QList<QDate> occurrences;
+        if (ev->recurs()) {
+            const QSet<QDateTime> exceptions = snapshot.exceptions.value(ev->uid());
+            const QList<QDateTime> times
+                = ev->recurrence()->timesInInterval(QDateTime(today.addDays(-extraDays),
+                                                              QTime(0, 0, 0), timeZone),
+                                                    QDateTime(lastDay, QTime(23, 59, 59),
+                                                              timeZone));
+            for (const QDateTime &time : times) {
+                if (exceptions.contains(time)) {
+                    // Exceptions are returned by the range query on their own
+                    continue;
+                }
+                occurrences.append(ev->allDay() ? time.date() : time.toTimeZone(timeZone).date());
+            }
+        } else {
+            occurrences.append(evStart);
+        }
 
-                    // Append Special Occasion Event?
-                    if (mShowSpecialsFromCal && (itUpper == QLatin1String("SPECIAL OCCASION"))) {
-                        SDEntry entry;
-                        entry.type = IncidenceTypeEvent;
-                        entry.category = CategoryOther;
-                        entry.date = dt;
-                        entry.summary = ev->summary();
-                        entry.desc = ev->description();
-                        dateDiff(dt, entry.daysTo, entry.yearsOld);
-                        entry.yearsOld = -1; //ignore age of special occasions
-                        entry.span = span(ev);
-                        if (entry.span > 1 && dayof(ev, dt) > 1) {     // skip days 2,3,...
-                            break;
-                        }
-                        mDates.append(entry);
-                        break;
-                    }
+        int birthdayDaysTo = 0;
+        int birthdayYears = 0;
+        if (category == CategoryBirthday || category == CategoryAnniversary) {
+            dateDiff(evStart, birthdayDaysTo, birthdayYears);
+        }
+
+        for (const QDate &occurrence : qAsConst(occurrences)) {
+            const QDate occurrenceEnd = occurrence.addDays(extraDays);
+            const QDate first = qMax(occurrence, today);
+            const QDate last = qMin(occurrenceEnd, lastDay);
+
+            for (QDate dt = first; dt <= last; dt = dt.addDays(1)) {
+                SDEntry entry;
+                entry.type = IncidenceTypeEvent;
+                entry.category = category;
+                entry.date = dt;
+                entry.summary = ev->summary();
+                entry.desc = ev->description();
+                entry.span = 1;
+
+                if (category == CategoryBirthday || category == CategoryAnniversary) {
+                    /* FIXME: prevent duplicate entries, so in case of having a KCal
+                     * incidence with category birthday with summary and date equal
+                     * to some KABC Atendee we don't show it. It was kresource based.
+                     * */
+                    entry.daysTo = birthdayDaysTo;
+                    entry.yearsOld = birthdayYears;
+                    appendEntry(entry);
+                    continue;
+                }
+
+                dateDiff(dt, entry.daysTo, entry.yearsOld);
+                entry.yearsOld = -1; //ignore age of holidays and special occasions
+                if (ev->allDay() && extraDays > 0) {
+                    // Multiday, floating events are shown once, on their first day
+                    entry.span = dt.daysTo(occurrenceEnd) + 1;
+                    appendEntry(entry);
+                    break;
                 }
+                appendEntry(entry);
             }
         }
     }
 
     // Search for Holidays
-    if (mShowHolidays) {
-        if (initHolidays()) {
-            for (dt = QDate::currentDate();
-                 dt <= QDate::currentDate().addDays(mDaysAhead - 1);
-                 dt = dt.addDays(1)) {
-                QList<Holiday> holidays = mHolidays->holidays(dt);
-                QList<Holiday>::ConstIterator it = holidays.constBegin();
-                for (; it != holidays.constEnd(); ++it) {
+    if (snapshot.showHolidays) {
+        if (!snapshot.holidayRegion.isEmpty()) {
+            const HolidayRegion region(snapshot.holidayRegion);
+            const Holiday::List holidays = region.holidays(today, lastDay);
+            for (const Holiday &holiday : holidays) {
+                SDCategory category;
+                const QStringList holidayCategories = holiday.categoryList();
+                if (holidayCategories.contains(QLatin1String("seasonal"))) {
+                    category = CategorySeasonal;
+                } else if (holidayCategories.contains(QLatin1String("public"))) {
+                    category = CategoryHoliday;
+                } else {
+                    category = CategoryOther;
+                }
+
+                const QDate last = qMin(holiday.observedEndDate(), lastDay);
+                for (QDate dt = qMax(holiday.observedStartDate(), today);
+                     dt <= last;
+                     dt = dt.addDays(1)) {
                     SDEntry entry;
                     entry.type = IncidenceTypeEvent;
-                    if ((*it).categoryList().contains(QLatin1String("seasonal"))) {
-                        entry.category = CategorySeasonal;
-                    } else if ((*it).categoryList().contains(QLatin1String("public"))) {
-                        entry.category = CategoryHoliday;
-                    } else {
-                        entry.category = CategoryOther;
-                    }
+                    entry.category = category;
                     entry.date = dt;
-                    entry.summary = (*it).name();
+                    entry.summary = holiday.name();
                     dateDiff(dt, entry.daysTo, entry.yearsOld);
                     entry.yearsOld = -1; //ignore age of holidays
                     entry.span = 1;
 
-                    mDates.append(entry);
+                    appendEntry(entry);
                 }
             }
         }
     }
 
+    for (const QList<SDEntry> &entries : qAsConst(entriesByDay)) {
+        dates += entries;
+    }
+    return dates;
+}
+
+void SDSummaryWidget::startCalendarScan()
+{
+    if (mCalendarWatcher->isRunning()) {
+        // Scanned again once the running scan is done
+        mScanPending = true;
+        return;
+    }
+    mScanPending = false;
+
+    // The calendar is scanned in a worker thread, on a copy of the events in
+    // range, so that we don't block the rest of Kontact.
+    SDCalendarSnapshot snapshot;
+    snapshot.daysAhead = mDaysAhead;
+    snapshot.timeZone = mCalendar->timeZone();
+    snapshot.showBirthdays = mShowBirthdaysFromCal;
+    snapshot.showAnniversaries = mShowAnniversariesFromCal;
+    snapshot.showHolidays = mShowHolidays;
+    snapshot.showSpecials = mShowSpecialsFromCal;
+    if (mShowHolidays) {
+        snapshot.holidayRegion = holidayRegion();
+    }
+
+    const QDate today = QDate::currentDate();
+    const KCalCore::Event::List events = mCalendar->events(today, today.addDays(mDaysAhead - 1),
+                                                           snapshot.timeZone);
+    snapshot.events.reserve(events.count());
+    for (const KCalCore::Event::Ptr &ev : events) {
+        if (ev->recurs()) {
+            const KCalCore::Incidence::List instances = mCalendar->instances(ev);
+            for (const KCalCore::Incidence::Ptr &instance : instances) {
+                snapshot.exceptions[ev->uid()].insert(instance->recurrenceId());
+            }
+        }
+        snapshot.events.append(KCalCore::Event::Ptr(ev->clone()));
+    }
+
+    mCalendarWatcher->setFuture(QtConcurrent::run(&SDSummaryWidget::calendarEntries, snapshot));
+}
+
+void SDSummaryWidget::slotCalendarScanFinished()
+{
+    if (mScanPending) {
+        startCalendarScan();
+        return;
+    }
+
+    mDates += mCalendarWatcher->result();
+    createLabels();
+}
+
+void SDSummaryWidget::createLabels()
+{
+    QLabel *label = nullptr;
+
+    // Remove all special date labels from the layout and delete them, as we
+    // will re-create all labels below.
+    setUpdatesEnabled(false);
+    foreach (label, mLabels) {
+        mLayout->removeWidget(label);
+        delete(label);
+        update();
+    }
+    mLabels.clear();
+
     // Sort, then Print the Special Dates
     std::sort(mDates.begin(), mDates.end());
 
@@ -632,16 +806,27 @@ void SDSummaryWidget::updateView()
      *
      **/
 
-    // Search for Birthdays
-    if (mShowBirthdaysFromKAB && !mJobRunning) {
-        BirthdaySearchJob *job = new BirthdaySearchJob(this, mDaysAhead);
+    // Search for Birthdays, unless the contacts we know are still current
+    if (mShowBirthdaysFromKAB) {
+        if (mJobRunning) {
+            // The result slot will trigger the rest of the update
+            return;
+        }
+        if (mBirthdayContactsDate != QDate::currentDate()
+            || mBirthdayContactsDaysAhead != mDaysAhead) {
+            BirthdaySearchJob *job = new BirthdaySearchJob(this, mDaysAhead);
 
-        connect(job, &BirthdaySearchJob::result, this, &SDSummaryWidget::slotBirthdayJobFinished);
-        job->start();
-        mJobRunning = true;
+            connect(job, &BirthdaySearchJob::result, this, &SDSummaryWidget::slotBirthdayJobFinished);
+            job->start();
+            mJobRunning = true;
 
-        // The result slot will trigger the rest of the update
+            // The result slot will trigger the rest of the update
+            return;
+        }
+        appendContactBirthdays();
     }
+
+    startCalendarScan();
 }
 
 void SDSummaryWidget::mailContact(const QString &url)
@@ -721,7 +906,7 @@ bool SDSummaryWidget::eventFilter(QObject *obj, QEvent *e)
     return KontactInterface::Summary::eventFilter(obj, e);
 }
 
-void SDSummaryWidget::dateDiff(const QDate &date, int &days, int &years) const
+void SDSummaryWidget::dateDiff(const QDate &date, int &days, int &years)
 {
     QDate currentDate;
     QDate eventDate;
@@ -30,19 +30,24 @@
 
 #include <KontactInterface/Summary>
 #include <Akonadi/Calendar/ETMCalendar>
+#include <AkonadiCore/Item>
 
-namespace KHolidays {
-class HolidayRegion;
-}
+#include <QDate>
+#include <QFutureWatcher>
+#include <QHash>
 
 namespace KontactInterface {
 class Plugin;
 }
 
-class QDate;
+namespace Akonadi {
+class Monitor;
+}
+
 class QGridLayout;
 class QLabel;
 class SDEntry;
+class SDCalendarSnapshot;
 class KJob;
 
 class SDSummaryWidget : public KontactInterface::Summary
@@ -70,12 +75,18 @@ private:
     void mailContact(const QString &url);
     void viewContact(const QString &url);
     void slotBirthdayJobFinished(KJob *job);
+    void slotBirthdayContactsFetched(KJob *job);
+    void slotContactChanged(const Akonadi::Item &item);
+    void slotContactRemoved(const Akonadi::Item &item);
+    void birthdayContactsUpdated();
+    void appendContactBirthdays();
     void slotItemFetchJobDone(KJob *job);
 
-    int span(const KCalCore::Event::Ptr &event) const;
-    int dayof(const KCalCore::Event::Ptr &event, const QDate &date) const;
-    bool initHolidays();
-    void dateDiff(const QDate &date, int &days, int &years) const;
+    QString holidayRegion() const;
+    static void dateDiff(const QDate &date, int &days, int &years);
+    static QList<SDEntry> calendarEntries(const SDCalendarSnapshot &snapshot);
+    void startCalendarScan();
+    void slotCalendarScanFinished();
     void createLabels();
 
     Akonadi::ETMCalendar::Ptr mCalendar;
@@ -94,8 +105,16 @@ private:
     bool mShowMineOnly = false;
     bool mJobRunning = false;
     QList<SDEntry> mDates;
-
-    KHolidays::HolidayRegion *mHolidays = nullptr;
+    QFutureWatcher<QList<SDEntry> > *mCalendarWatcher = nullptr;
+    bool mScanPending = false;
+
+    // Contacts with a birthday, as found by the last BirthdaySearchJob and
+    // kept up to date by mContactMonitor. The search is only run again when
+    // the date or the number of days to show changes.
+    QHash<Akonadi::Item::Id, Akonadi::Item> mBirthdayContacts;
+    Akonadi::Monitor *mContactMonitor = nullptr;
+    QDate mBirthdayContactsDate;
+    int mBirthdayContactsDaysAhead = -1;
 };
 
 #endif
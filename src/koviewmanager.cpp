@@ -27,6 +27,8 @@
 #include "actionmanager.h"
 #include "calendarview.h"
 #include "datenavigator.h"
+#include "datenavigatorcontainer.h"
+#include "dayinfocache.h"
 #include "koglobals.h"
 #include "prefs/koprefs.h"
 #include "widgets/navigatorbar.h"
@@ -45,9 +47,25 @@
 #include <QTabWidget>
 
 #include <QAction>
+#include <QApplication>
+#include <QHash>
+#include <QSignalBlocker>
 #include <QStackedWidget>
+#include <QTimer>
 #include <KSharedConfig>
 
+#include <algorithm>
+
+//Idle time after startup before the first view is prepared, and between two views
+static const int PrewarmDelay = 3000;
+static const int PrewarmInterval = 1000;
+//Prepared views which have not been shown by then are dropped again
+static const int PrewarmedViewLifetime = 10 * 60 * 1000;
+//Number of view switches remembered to guess the next one
+static const int ViewHistorySize = 20;
+//Time after the last navigation before the ranges next to it are prepared
+static const int PrefetchDelay = 300;
+
 KOViewManager::KOViewManager(CalendarView *mainView)
     : QObject()
     , mMainView(mainView)
@@ -65,10 +83,28 @@ KOViewManager::KOViewManager(CalendarView *mainView)
     mAgendaViewTabIndex = 0;
     mMonthView = nullptr;
     mRangeMode = NO_RANGE;
+
+    mPrewarmTimer = new QTimer(this);
+    mPrewarmTimer->setSingleShot(true);
+    connect(mPrewarmTimer, &QTimer::timeout, this, &KOViewManager::prewarmNextView);
+
+    mDropPrewarmedTimer = new QTimer(this);
+    mDropPrewarmedTimer->setSingleShot(true);
+    mDropPrewarmedTimer->setInterval(PrewarmedViewLifetime);
+    connect(mDropPrewarmedTimer, &QTimer::timeout, this, &KOViewManager::dropPrewarmedViews);
+
+    mDayInfoCache = new DayInfoCache([mainView]() {
+        return mainView->changeGeneration();
+    });
+    mPrefetchTimer = new QTimer(this);
+    mPrefetchTimer->setSingleShot(true);
+    mPrefetchTimer->setInterval(PrefetchDelay);
+    connect(mPrefetchTimer, &QTimer::timeout, this, &KOViewManager::prefetchAdjacentRanges);
 }
 
 KOViewManager::~KOViewManager()
 {
+    delete mDayInfoCache;
 }
 
 KOrg::BaseView *KOViewManager::currentView()
@@ -100,6 +136,8 @@ void KOViewManager::readSettings(KConfig *config)
     } else {
         showAgendaView();
     }
+    // Read after restoring the view, which is not a switch the user made
+    mViewHistory = generalConfig.readEntry("View History", QStringList());
 
     mRangeMode = RangeMode(generalConfig.readEntry("Range Mode", int(OTHER_RANGE)));
 
@@ -121,29 +159,17 @@ void KOViewManager::readSettings(KConfig *config)
         // Someone has been playing with the config file.
         mRangeMode = OTHER_RANGE;
     }
+
+    if (KOPrefs::instance()->prewarmViews()) {
+        mPrewarmTimer->start(PrewarmDelay);
+    }
 }
 
 void KOViewManager::writeSettings(KConfig *config)
 {
     KConfigGroup generalConfig(config, "General");
-    QString view;
-    if (mCurrentView == mWhatsNextView) {
-        view = QStringLiteral("WhatsNext");
-    } else if (mCurrentView == mListView) {
-        view = QStringLiteral("List");
-    } else if (mCurrentView == mJournalView) {
-        view = QStringLiteral("Journal");
-    } else if (mCurrentView == mTodoView) {
-        view = QStringLiteral("Todo");
-    } else if (mCurrentView == mTimelineView) {
-        view = QStringLiteral("Timeline");
-    } else if (mCurrentView == mMonthView) {
-        view = QStringLiteral("Month");
-    } else {
-        view = QStringLiteral("Agenda");
-    }
-
-    generalConfig.writeEntry("Current View", view);
+    generalConfig.writeEntry("Current View", viewName(mCurrentView));
+    generalConfig.writeEntry("View History", mViewHistory);
 
     if (mAgendaView) {
         mAgendaView->writeSettings(config);
@@ -173,6 +199,17 @@ void KOViewManager::showView(KOrg::BaseView *view)
     mCurrentView = view;
     mMainView->updateHighlightModes();
 
+    if (mCurrentView) {
+        mViewHistory.prepend(viewName(mCurrentView));
+        while (mViewHistory.count() > ViewHistorySize) {
+            mViewHistory.removeLast();
+        }
+        // A prepared view is kept like any other once it is used, which makes room for the next one
+        if (mPrewarmedViews.removeOne(mCurrentView) && KOPrefs::instance()->prewarmViews()) {
+            mPrewarmTimer->start(PrewarmInterval);
+        }
+    }
+
     if (mCurrentView && mCurrentView->isEventView()) {
         mLastEventView = mCurrentView;
     }
@@ -266,12 +303,28 @@ void KOViewManager::updateView()
 void KOViewManager::updateView(const QDate &start, const QDate &end, const QDate &preferredMonth)
 {
     if (mCurrentView && mCurrentView != mTodoView) {
+        // Nothing to do if neither the dates nor the calendar changed since the view showed them
+        const quint64 generation = changeGeneration(mCurrentView);
+        if (mCurrentView->isUpToDate(generation, start, end, preferredMonth)) {
+            return;
+        }
         mCurrentView->setDateRange(QDateTime(start), QDateTime(end), preferredMonth);
+        mCurrentView->setUpToDate(generation, start, end, preferredMonth);
+        // Prepares the navigator for the adjacent ranges. Restarted while paging quickly,
+        // only the range the user stops at is worth preparing
+        mPrefetchTimer->start();
     } else if (mTodoView) {
         mTodoView->updateView();
     }
 }
 
+quint64 KOViewManager::changeGeneration(KOrg::BaseView *view) const
+{
+    // Views updating themselves on incidence changes only go out of date with the settings
+    return view->observesCalendar() ? mMainView->settingsGeneration()
+                                    : mMainView->changeGeneration();
+}
+
 void KOViewManager::connectView(KOrg::BaseView *view)
 {
     if (!view) {
@@ -402,7 +455,7 @@ void KOViewManager::addView(KOrg::BaseView *view, bool isTab)
     }
 }
 
-void KOViewManager::showMonthView()
+void KOViewManager::createMonthView()
 {
     if (!mMonthView) {
         mMonthView = new KOrg::MonthView(mMainView->viewStack());
@@ -412,11 +465,16 @@ void KOViewManager::showMonthView()
         connect(mMonthView, &MonthView::fullViewChanged,
                 mMainView, &CalendarView::changeFullView);
     }
+}
+
+void KOViewManager::showMonthView()
+{
+    createMonthView();
     goMenu(true);
     showView(mMonthView);
 }
 
-void KOViewManager::showWhatsNextView()
+void KOViewManager::createWhatsNextView()
 {
     if (!mWhatsNextView) {
         mWhatsNextView = new KOWhatsNextView(mMainView->viewStack());
@@ -424,22 +482,32 @@ void KOViewManager::showWhatsNextView()
         mWhatsNextView->setIdentifier("DefaultWhatsNextView");
         addView(mWhatsNextView);
     }
+}
+
+void KOViewManager::showWhatsNextView()
+{
+    createWhatsNextView();
     goMenu(true);
     showView(mWhatsNextView);
 }
 
-void KOViewManager::showListView()
+void KOViewManager::createListView()
 {
     if (!mListView) {
         mListView = new KOListView(mMainView->calendar(), mMainView->viewStack());
         mListView->setIdentifier("DefaultListView");
         addView(mListView);
     }
+}
+
+void KOViewManager::showListView()
+{
+    createListView();
     goMenu(true);
     showView(mListView);
 }
 
-void KOViewManager::showAgendaView()
+KOrg::BaseView *KOViewManager::createAgendaViews()
 {
     const bool showBoth
         = KOPrefs::instance()->agendaViewCalendarDisplay() == KOPrefs::AllCalendarViews;
@@ -485,17 +553,23 @@ void KOViewManager::showAgendaView()
     }
 
     if (showSideBySide) {
-        if (!mAgendaSideBySideView) {
-            mAgendaSideBySideView = new MultiAgendaView(parent);
-            mAgendaSideBySideView->setIdentifier("DefaultAgendaSideBySideView");
-            mAgendaSideBySideView->setCalendar(mMainView->calendar());
-            addView(mAgendaSideBySideView, showBoth);
-
-            /*
-                connect( mAgendaSideBySideView,SIGNAL(zoomViewHorizontally(QDate,int)),
-                         mMainView->dateNavigator(),SLOT(selectDates(QDate,int)) );*/
+        if (showBoth && !mAgendaSideBySideView) {
+            // With an agenda per calendar the side-by-side view is expensive, so in
+            // tabs it is only created once its tab is opened. Once created, it still
+            // builds and lays out the agendas of all calendars, visible or not.
+            // See currentAgendaViewTabChanged().
+            if (!mSideBySidePlaceholder) {
+                mSideBySidePlaceholder = new QWidget(mAgendaViewTabs);
+                mAgendaViewTabs->addTab(mSideBySidePlaceholder, i18n("Calendars Side by Side"));
+                mAgendaViewTabs->setCurrentIndex(mAgendaViewTabIndex);
+            }
+        } else if (!mAgendaSideBySideView) {
+            createSideBySideView(parent, false);
         }
-        if (showBoth && mAgendaViewTabs->indexOf(mAgendaSideBySideView) < 0) {
+        if (showBoth && mAgendaSideBySideView && mSideBySidePlaceholder) {
+            replaceSideBySidePlaceholder();
+        } else if (showBoth && mAgendaSideBySideView
+                   && mAgendaViewTabs->indexOf(mAgendaSideBySideView) < 0) {
             mAgendaViewTabs->addTab(mAgendaSideBySideView, i18n("Calendars Side by Side"));
             mAgendaViewTabs->setCurrentIndex(mAgendaViewTabIndex);
         } else if (!showBoth && mMainView->viewStack()->indexOf(mAgendaSideBySideView) < 0) {
@@ -504,13 +578,50 @@ void KOViewManager::showAgendaView()
         }
     }
 
-    goMenu(true);
     if (showBoth) {
-        showView(static_cast<KOrg::BaseView *>(mAgendaViewTabs->currentWidget()));
+        return static_cast<KOrg::BaseView *>(mAgendaViewTabs->currentWidget());
     } else if (showMerged) {
-        showView(mAgendaView);
-    } else if (showSideBySide) {
-        showView(mAgendaSideBySideView);
+        return mAgendaView;
+    } else {
+        return mAgendaSideBySideView;
+    }
+}
+
+void KOViewManager::createSideBySideView(QWidget *parent, bool isTab)
+{
+    mAgendaSideBySideView = new MultiAgendaView(parent);
+    mAgendaSideBySideView->setIdentifier("DefaultAgendaSideBySideView");
+    mAgendaSideBySideView->setCalendar(mMainView->calendar());
+    addView(mAgendaSideBySideView, isTab);
+
+    /*
+        connect( mAgendaSideBySideView,SIGNAL(zoomViewHorizontally(QDate,int)),
+                 mMainView->dateNavigator(),SLOT(selectDates(QDate,int)) );*/
+}
+
+void KOViewManager::replaceSideBySidePlaceholder()
+{
+    const int index = mAgendaViewTabs->indexOf(mSideBySidePlaceholder);
+    const bool isCurrent = mAgendaViewTabs->currentIndex() == index;
+    {
+        // Switching tabs is up to the caller
+        const QSignalBlocker blocker(mAgendaViewTabs);
+        mAgendaViewTabs->removeTab(index);
+        mAgendaViewTabs->insertTab(index, mAgendaSideBySideView, i18n("Calendars Side by Side"));
+        if (isCurrent) {
+            mAgendaViewTabs->setCurrentIndex(index);
+        }
+    }
+    mSideBySidePlaceholder->deleteLater();
+    mSideBySidePlaceholder = nullptr;
+}
+
+void KOViewManager::showAgendaView()
+{
+    KOrg::BaseView *view = createAgendaViews();
+    goMenu(true);
+    if (view) {
+        showView(view);
     }
 }
 
@@ -549,7 +660,7 @@ void KOViewManager::selectNextX()
                                             KOPrefs::instance()->mNextXDays);
 }
 
-void KOViewManager::showTodoView()
+void KOViewManager::createTodoView()
 {
     if (!mTodoView) {
         mTodoView = new KOTodoView(false /*not sidebar*/, mMainView->viewStack());
@@ -562,11 +673,16 @@ void KOViewManager::showTodoView()
         KSharedConfig::Ptr config = KSharedConfig::openConfig();
         mTodoView->restoreLayout(config.data(), QStringLiteral("Todo View"), false);
     }
+}
+
+void KOViewManager::showTodoView()
+{
+    createTodoView();
     goMenu(false);
     showView(mTodoView);
 }
 
-void KOViewManager::showJournalView()
+void KOViewManager::createJournalView()
 {
     if (!mJournalView) {
         mJournalView = new KOJournalView(mMainView->viewStack());
@@ -574,11 +690,16 @@ void KOViewManager::showJournalView()
         mJournalView->setIdentifier("DefaultJournalView");
         addView(mJournalView);
     }
+}
+
+void KOViewManager::showJournalView()
+{
+    createJournalView();
     goMenu(true);
     showView(mJournalView);
 }
 
-void KOViewManager::showTimeLineView()
+void KOViewManager::createTimeLineView()
 {
     if (!mTimelineView) {
         mTimelineView = new KOTimelineView(mMainView->viewStack());
@@ -586,6 +707,11 @@ void KOViewManager::showTimeLineView()
         mTimelineView->setIdentifier("DefaultTimelineView");
         addView(mTimelineView);
     }
+}
+
+void KOViewManager::showTimeLineView()
+{
+    createTimeLineView();
     goMenu(true);
     showView(mTimelineView);
 }
@@ -650,6 +776,11 @@ void KOViewManager::currentAgendaViewTabChanged(int index)
     if (index > -1) {
         goMenu(true);
         QWidget *widget = mAgendaViewTabs->widget(index);
+        if (widget && widget == mSideBySidePlaceholder) {
+            createSideBySideView(mAgendaViewTabs, true);
+            replaceSideBySidePlaceholder();
+            widget = mAgendaSideBySideView;
+        }
         if (widget) {
             showView(static_cast<KOrg::BaseView *>(widget));
         }
@@ -680,3 +811,162 @@ bool KOViewManager::agendaIsSelected() const
            || mCurrentView == mAgendaSideBySideView
            || (mAgendaViewTabs && mCurrentView == mAgendaViewTabs->currentWidget());
 }
+
+QString KOViewManager::viewName(KOrg::BaseView *view) const
+{
+    if (!view) {
+        return QStringLiteral("Agenda");
+    } else if (view == mWhatsNextView) {
+        return QStringLiteral("WhatsNext");
+    } else if (view == mListView) {
+        return QStringLiteral("List");
+    } else if (view == mJournalView) {
+        return QStringLiteral("Journal");
+    } else if (view == mTodoView) {
+        return QStringLiteral("Todo");
+    } else if (view == mTimelineView) {
+        return QStringLiteral("Timeline");
+    } else if (view == mMonthView) {
+        return QStringLiteral("Month");
+    } else {
+        return QStringLiteral("Agenda");
+    }
+}
+
+QStringList KOViewManager::likelyNextViews() const
+{
+    // Rank the views by how often they were shown lately, the most recent first on a tie
+    QStringList names;
+    QHash<QString, int> counts;
+    for (const QString &name : qAsConst(mViewHistory)) {
+        if (!counts.contains(name)) {
+            names.append(name);
+        }
+        ++counts[name];
+    }
+    std::stable_sort(names.begin(), names.end(), [&counts](const QString &a, const QString &b) {
+        return counts.value(a) > counts.value(b);
+    });
+
+    // Without much of a history, fall back to the views used most
+    const QStringList defaults = { QStringLiteral("Agenda"), QStringLiteral("Month"),
+                                   QStringLiteral("Todo"), QStringLiteral("List") };
+    for (const QString &name : defaults) {
+        if (!names.contains(name)) {
+            names.append(name);
+        }
+    }
+
+    names.removeAll(viewName(mCurrentView));
+    return names;
+}
+
+KOrg::BaseView *KOViewManager::createView(const QString &name)
+{
+    if (name == QLatin1String("WhatsNext") && !mWhatsNextView) {
+        createWhatsNextView();
+        return mWhatsNextView;
+    } else if (name == QLatin1String("List") && !mListView) {
+        createListView();
+        return mListView;
+    } else if (name == QLatin1String("Journal") && !mJournalView) {
+        createJournalView();
+        return mJournalView;
+    } else if (name == QLatin1String("Todo") && !mTodoView) {
+        createTodoView();
+        return mTodoView;
+    } else if (name == QLatin1String("Timeline") && !mTimelineView) {
+        createTimeLineView();
+        return mTimelineView;
+    } else if (name == QLatin1String("Month") && !mMonthView) {
+        createMonthView();
+        return mMonthView;
+    } else if (name == QLatin1String("Agenda") && !mAgendaView && !mAgendaSideBySideView
+               && KOPrefs::instance()->agendaViewCalendarDisplay() != KOPrefs::AllCalendarViews) {
+        // Not with both agenda views, adding their tabs would switch to them
+        return createAgendaViews();
+    }
+    return nullptr;
+}
+
+void KOViewManager::prewarmNextView()
+{
+    // Don't block the event loop while the user is dragging or has a menu open
+    if (QApplication::mouseButtons() != Qt::NoButton || QApplication::activePopupWidget()) {
+        mPrewarmTimer->start(PrewarmInterval);
+        return;
+    }
+    if (!mCurrentView || mPrewarmedViews.count() >= KOPrefs::instance()->prewarmViewBudget()) {
+        return;
+    }
+
+    const QStringList names = likelyNextViews();
+    for (const QString &name : names) {
+        KOrg::BaseView *view = createView(name);
+        if (!view) {
+            continue;
+        }
+        mPrewarmedViews.append(view);
+
+        // Fill the view with the dates shown now, so it is up to date when switching to it
+        if (view != mTodoView) {
+            const KCalCore::DateList dates = mMainView->dateNavigator()->selectedDates();
+            const QDate preferredMonth = mMainView->preferredMonth();
+            view->setDateRange(QDateTime(dates.first()), QDateTime(dates.last()), preferredMonth);
+            view->setUpToDate(changeGeneration(view), dates.first(), dates.last(), preferredMonth);
+        }
+
+        // One view at a time, the user gets the event loop back in between
+        mPrewarmTimer->start(PrewarmInterval);
+        mDropPrewarmedTimer->start();
+        return;
+    }
+}
+
+void KOViewManager::dropPrewarmedViews()
+{
+    for (KOrg::BaseView *view : qAsConst(mPrewarmedViews)) {
+        mViews.removeOne(view);
+        mMainView->viewStack()->removeWidget(view);
+        if (view == mWhatsNextView) {
+            mWhatsNextView = nullptr;
+        } else if (view == mListView) {
+            mListView = nullptr;
+        } else if (view == mJournalView) {
+            mJournalView = nullptr;
+        } else if (view == mTodoView) {
+            mTodoView = nullptr;
+        } else if (view == mTimelineView) {
+            mTimelineView = nullptr;
+        } else if (view == mMonthView) {
+            mMonthView = nullptr;
+        } else if (view == mAgendaView) {
+            mAgendaView = nullptr;
+        } else if (view == mAgendaSideBySideView) {
+            mAgendaSideBySideView = nullptr;
+        }
+        view->deleteLater();
+    }
+    mPrewarmedViews.clear();
+}
+
+void KOViewManager::prefetchAdjacentRanges()
+{
+    DateNavigatorContainer *navigator = mMainView->dateNavigatorContainer();
+    if (!mCurrentView || mCurrentView == mTodoView || !navigator->isVisible()) {
+        return;
+    }
+
+    if (mCurrentView == mMonthView) {
+        // The month view goes to the next and previous month
+        const QDate month = mMainView->preferredMonth();
+        navigator->prefetch(month.addMonths(1));
+        navigator->prefetch(month.addMonths(-1));
+    } else {
+        // The other views go forward and back by the number of selected days
+        const KCalCore::DateList dates = mMainView->dateNavigator()->selectedDates();
+        const int days = dates.first().daysTo(dates.last()) + 1;
+        navigator->prefetch(dates.last().addDays(1));
+        navigator->prefetch(dates.first().addDays(-days));
+    }
+}
@@ -34,6 +34,7 @@
 #include <QObject>
 
 class CalendarView;
+class DayInfoCache;
 class KOAgendaView;
 class KOJournalView;
 class KOListView;
@@ -52,10 +53,15 @@ class Item;
 
 class KConfig;
 class QTabWidget;
+class QTimer;
 
 /**
   This class manages the views of the calendar. It owns the objects and handles
   creation and selection.
+
+  Views are created when they are shown first. With the PrewarmViews option
+  the views the user is likely to switch to next are created and filled ahead
+  of time while the application is idle after startup.
 */
 class KOViewManager : public QObject
 {
@@ -128,6 +134,15 @@ public:
 
     void updateMultiCalendarDisplay();
 
+    /**
+     * Returns the cache of the days shown by the date navigator, which
+     * is filled ahead for the ranges next to the current one.
+     */
+    DayInfoCache *dayInfoCache() const
+    {
+        return mDayInfoCache;
+    }
+
     /**
      * Returns true if agenda is the current view.
      *
@@ -184,6 +199,36 @@ private Q_SLOTS:
 
 private:
     QWidget *widgetForView(KOrg::BaseView *) const;
+    /** Returns the change generation of the calendar that @p view depends on */
+    quint64 changeGeneration(KOrg::BaseView *view) const;
+
+    void createMonthView();
+    void createWhatsNextView();
+    void createListView();
+    /** Creates the agenda views of the configured display mode, returns the one to show */
+    KOrg::BaseView *createAgendaViews();
+    void createSideBySideView(QWidget *parent, bool isTab);
+    /** Puts the side-by-side view into the tab held for it until it was needed */
+    void replaceSideBySidePlaceholder();
+    void createTodoView();
+    void createJournalView();
+    void createTimeLineView();
+
+    /** Returns the name @p view is stored under in the config file */
+    QString viewName(KOrg::BaseView *view) const;
+    /** Returns the names of the views most likely to be shown next, most likely first */
+    QStringList likelyNextViews() const;
+    /** Creates the view called @p name, returns nullptr if it exists already */
+    KOrg::BaseView *createView(const QString &name);
+    void prewarmNextView();
+    void dropPrewarmedViews();
+    /**
+     * Prepares the date navigator's days of the next and previous range of the current view.
+     * Only the navigator is prepared: the views expand and lay out their items when they
+     * are given the range.
+     */
+    void prefetchAdjacentRanges();
+
     QList<KOrg::BaseView *> mViews;
     CalendarView *mMainView = nullptr;
 
@@ -199,9 +244,21 @@ private:
 
     KOrg::BaseView *mLastEventView = nullptr;
     QTabWidget *mAgendaViewTabs = nullptr;
+    //Holds the tab of the side-by-side view until it is opened first
+    QWidget *mSideBySidePlaceholder = nullptr;
     int mAgendaViewTabIndex;
 
     RangeMode mRangeMode;
+
+    //Names of the views shown last, most recent first
+    QStringList mViewHistory;
+    //Views created ahead of time which have not been shown yet
+    QList<KOrg::BaseView *> mPrewarmedViews;
+    QTimer *mPrewarmTimer = nullptr;
+    QTimer *mDropPrewarmedTimer = nullptr;
+
+    DayInfoCache *mDayInfoCache = nullptr;
+    QTimer *mPrefetchTimer = nullptr;
 };
 
 #endif
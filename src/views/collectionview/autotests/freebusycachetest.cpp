@@ -0,0 +1,187 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * As a special exception, permission is given to link this program
+ * with any edition of Qt, and distribute the resulting executable,
+ * without including the source code for Qt in the source distribution.
+ */
+
+#include <QObject>
+#include <QTest>
+#include <QFile>
+#include <QPointer>
+#include <KCalCore/Event>
+#include <KCalCore/FreeBusy>
+#include <KCalCore/ICalFormat>
+#include <KCalCore/MemoryCalendar>
+#include "freebusycache.h"
+
+static const QColor busyColor(255, 0, 0);
+static const QColor freeColor(0, 255, 0);
+
+class FreeBusyCacheTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    //Stands in for the download, the data is filled from a file by finishDownload()
+    FreeBusyCache::Factory factory()
+    {
+        return [this](const KCalCore::Attendee::Ptr &attendee) {
+            Q_UNUSED(attendee);
+            ++mCreated;
+            return new FreeBusyData(KCalCore::MemoryCalendar::Ptr(
+                                        new KCalCore::MemoryCalendar(QTimeZone::utc())));
+        };
+    }
+
+    //Adds the periods of the free/busy file the way the free/busy calendar does
+    static void finishDownload(const KCalCore::Calendar::Ptr &calendar)
+    {
+        QFile file(QFINDTESTDATA("data/freebusy.ifb"));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        KCalCore::ICalFormat format;
+        const KCalCore::FreeBusy::Ptr freeBusy
+            = format.parseFreeBusy(QString::fromUtf8(file.readAll()));
+        QVERIFY(freeBusy);
+
+        const KCalCore::FreeBusyPeriod::List periods = freeBusy->fullBusyPeriods();
+        for (int i = 0; i < periods.count(); ++i) {
+            const KCalCore::FreeBusyPeriod &period = periods.at(i);
+            KCalCore::Event::Ptr event(new KCalCore::Event());
+            event->setUid(QStringLiteral("fb-%1").arg(i));
+            event->setDtStart(period.start());
+            event->setDtEnd(period.end());
+            event->setCustomProperty("FREEBUSY", "STATUS", QString::number(period.type()));
+            calendar->addEvent(event);
+        }
+    }
+
+    static KCalCore::Attendee::Ptr attendee(const QString &email)
+    {
+        return KCalCore::Attendee::Ptr(new KCalCore::Attendee(QStringLiteral("John Doe"), email));
+    }
+
+    int mCreated = 0;
+
+private Q_SLOTS:
+    void init()
+    {
+        mCreated = 0;
+    }
+
+    void shouldShareDataOfEmailsDifferingInCase()
+    {
+        FreeBusyCache cache(factory());
+        FreeBusyData *data = cache.data(attendee(QStringLiteral("john@example.org")));
+        QCOMPARE(cache.data(attendee(QStringLiteral("John@Example.ORG"))), data);
+        QCOMPARE(mCreated, 1);
+
+        QVERIFY(cache.data(attendee(QStringLiteral("jane@example.org"))) != data);
+        QCOMPARE(mCreated, 2);
+    }
+
+    void shouldReturnDataWhileDownloading()
+    {
+        FreeBusyCache cache(factory());
+        FreeBusyData *data = cache.data(attendee(QStringLiteral("john@example.org")));
+        QVERIFY(data->calendar->incidences().isEmpty());
+
+        QCOMPARE(cache.data(attendee(QStringLiteral("john@example.org"))), data);
+        finishDownload(data->calendar);
+        QCOMPARE(data->calendar->incidences().count(), 3);
+        QCOMPARE(cache.data(attendee(QStringLiteral("john@example.org"))), data);
+        QCOMPARE(mCreated, 1);
+    }
+
+    void shouldRecreateExpiredData()
+    {
+        FreeBusyCache cache(factory());
+        const QDateTime now(QDate(2017, 1, 2), QTime(8, 0), Qt::UTC);
+        QPointer<FreeBusyData> data = cache.data(attendee(QStringLiteral("john@example.org")), now);
+        finishDownload(data->calendar);
+
+        QCOMPARE(cache.data(attendee(QStringLiteral("john@example.org")),
+                            now.addSecs(FreeBusyCache::ExpirySecs)), data.data());
+        QCOMPARE(mCreated, 1);
+
+        FreeBusyData *recreated = cache.data(attendee(QStringLiteral("john@example.org")),
+                                             now.addSecs(FreeBusyCache::ExpirySecs + 1));
+        QVERIFY(recreated != data);
+        QCOMPARE(mCreated, 2);
+        QVERIFY(recreated->calendar->incidences().isEmpty());
+
+        //The expired data is deleted once the quickviews are done with it
+        QVERIFY(data);
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        QVERIFY(data.isNull());
+    }
+
+    void shouldDropColorOfChangedPeriod()
+    {
+        KCalCore::MemoryCalendar::Ptr calendar(new KCalCore::MemoryCalendar(QTimeZone::utc()));
+        finishDownload(calendar);
+        const KCalCore::Incidence::Ptr period = calendar->incidence(QStringLiteral("fb-0"));
+        QVERIFY(period);
+
+        FreebusyViewCalendar viewCalendar;
+        QCOMPARE(viewCalendar.resourceColor(period), busyColor);
+
+        //The calendar of the period isn't observed, so the color stays cached
+        period->setCustomProperty("FREEBUSY", "STATUS",
+                                  QString::number(KCalCore::FreeBusyPeriod::Free));
+        QCOMPARE(viewCalendar.resourceColor(period), busyColor);
+
+        viewCalendar.calendarIncidenceChanged(period);
+        QCOMPARE(viewCalendar.resourceColor(period), freeColor);
+    }
+
+    void shouldDropColorOfDeletedPeriod()
+    {
+        KCalCore::MemoryCalendar::Ptr calendar(new KCalCore::MemoryCalendar(QTimeZone::utc()));
+        finishDownload(calendar);
+        const KCalCore::Incidence::Ptr period = calendar->incidence(QStringLiteral("fb-0"));
+        QVERIFY(period);
+
+        FreebusyViewCalendar viewCalendar;
+        QCOMPARE(viewCalendar.resourceColor(period), busyColor);
+
+        period->setCustomProperty("FREEBUSY", "STATUS",
+                                  QString::number(KCalCore::FreeBusyPeriod::Free));
+        viewCalendar.calendarIncidenceDeleted(period, calendar.data());
+        QCOMPARE(viewCalendar.resourceColor(period), freeColor);
+    }
+
+    void shouldDropColorsOfObservedCalendar()
+    {
+        KCalCore::MemoryCalendar::Ptr calendar(new KCalCore::MemoryCalendar(QTimeZone::utc()));
+        finishDownload(calendar);
+        const KCalCore::Incidence::Ptr period = calendar->incidence(QStringLiteral("fb-0"));
+        QVERIFY(period);
+
+        FreebusyViewCalendar viewCalendar;
+        viewCalendar.setCalendar(calendar);
+        QCOMPARE(viewCalendar.resourceColor(period), busyColor);
+
+        //Changing the period notifies the observers of its calendar
+        period->setCustomProperty("FREEBUSY", "STATUS",
+                                  QString::number(KCalCore::FreeBusyPeriod::Free));
+        QCOMPARE(viewCalendar.resourceColor(period), freeColor);
+    }
+};
+
+QTEST_MAIN(FreeBusyCacheTest)
+
+#include "freebusycachetest.moc"
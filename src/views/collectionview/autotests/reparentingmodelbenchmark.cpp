@@ -0,0 +1,352 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * As a special exception, permission is given to link this program
+ * with any edition of Qt, and distribute the resulting executable,
+ * without including the source code for Qt in the source distribution.
+ */
+
+#include <QObject>
+#include <QTest>
+#include <QStandardItemModel>
+#include "korganizer_debug.h"
+#include "reparentingmodel.h"
+#include "calendardelegatemodel.h"
+#include "controller.h"
+
+/**
+ * A person node adopting all collections whose name starts with the name of the person
+ */
+class BenchmarkPersonNode : public ReparentingModel::Node
+{
+public:
+    BenchmarkPersonNode(ReparentingModel &personModel, const QString &name)
+        : ReparentingModel::Node(personModel)
+        , mName(name)
+        , mPrefix(name + QLatin1Char('-'))
+    {
+    }
+
+    bool operator==(const Node &node) const override
+    {
+        const BenchmarkPersonNode *personNode = dynamic_cast<const BenchmarkPersonNode *>(&node);
+        if (personNode) {
+            return personNode->mName == mName;
+        }
+        return false;
+    }
+
+private:
+    QVariant data(int role) const override
+    {
+        if (role == Qt::DisplayRole) {
+            return mName;
+        } else if (role == NodeTypeRole) {
+            return PersonNodeRole;
+        }
+        return QVariant();
+    }
+
+    bool adopts(const QModelIndex &sourceIndex) override
+    {
+        return sourceIndex.data().toString().startsWith(mPrefix);
+    }
+
+    QString mName;
+    QString mPrefix;
+};
+
+/*
+ * Source structure, with collections spread evenly over the resources and persons:
+ * -- + resource0
+ *    -- person0-collection0
+ *    -- person1-collection1
+ *    ...
+ * -- + resource1
+ *    ...
+ */
+static const int resourceCount = 10;
+
+static int personCount(int collections)
+{
+    return qBound(1, collections / 10, 100);
+}
+
+static QStandardItem *createCollection(int collection, int persons)
+{
+    QStandardItem *item = new QStandardItem(QStringLiteral("person%1-collection%2").arg(
+                                                collection % persons).arg(collection));
+    item->setCheckable(true);
+    item->setCheckState(collection % 3 ? Qt::Checked : Qt::Unchecked);
+    return item;
+}
+
+static void fillSourceModel(QStandardItemModel &model, int collections)
+{
+    const int persons = personCount(collections);
+    for (int r = 0; r < resourceCount; ++r) {
+        QStandardItem *resource = new QStandardItem(QStringLiteral("resource%1").arg(r));
+        QList<QStandardItem *> items;
+        for (int c = r; c < collections; c += resourceCount) {
+            items << createCollection(c, persons);
+        }
+        resource->appendRows(items);
+        model.appendRow(resource);
+    }
+}
+
+static void addPersons(ReparentingModel &model, int collections)
+{
+    const int persons = personCount(collections);
+    for (int p = 0; p < persons; ++p) {
+        model.addNode(ReparentingModel::Node::Ptr(new BenchmarkPersonNode(model,
+                                                                          QStringLiteral("person%1").arg(p))));
+    }
+    //Process the queued node additions
+    QTest::qWait(0);
+}
+
+static void collectSourceIndexes(const QAbstractItemModel &model, const QModelIndex &parent,
+                                 QModelIndexList &list)
+{
+    for (int i = 0; i < model.rowCount(parent); ++i) {
+        const QModelIndex index = model.index(i, 0, parent);
+        list << index;
+        collectSourceIndexes(model, index, list);
+    }
+}
+
+static int walk(const QAbstractItemModel &model, const QModelIndex &parent)
+{
+    int count = 0;
+    for (int i = 0; i < model.rowCount(parent); ++i) {
+        const QModelIndex index = model.index(i, 0, parent);
+        if (model.parent(index) == parent) {
+            count++;
+        }
+        count += walk(model, index);
+    }
+    return count;
+}
+
+static void queryCheckStates(const CalendarDelegateModel &delegateModel)
+{
+    for (int i = 0; i < delegateModel.rowCount(QModelIndex()); ++i) {
+        const QModelIndex index = delegateModel.index(i, 0);
+        delegateModel.data(index, Qt::CheckStateRole);
+        delegateModel.data(index, EnabledRole);
+    }
+}
+
+class ReparentingModelBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchmarkReset_data();
+    void benchmarkReset();
+    void benchmarkInsert_data();
+    void benchmarkInsert();
+    void benchmarkRemove_data();
+    void benchmarkRemove();
+    void benchmarkMapFromSource_data();
+    void benchmarkMapFromSource();
+    void benchmarkIndexParentWalk_data();
+    void benchmarkIndexParentWalk();
+    void benchmarkCheckState_data();
+    void benchmarkCheckState();
+    void benchmarkCheckStateCold_data();
+    void benchmarkCheckStateCold();
+
+private:
+    void sizes();
+};
+
+void ReparentingModelBenchmark::sizes()
+{
+    QTest::addColumn<int>("collections");
+    QTest::newRow("10") << 10;
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+}
+
+void ReparentingModelBenchmark::benchmarkReset_data()
+{
+    sizes();
+}
+
+void ReparentingModelBenchmark::benchmarkReset()
+{
+    QFETCH(int, collections);
+    QStandardItemModel sourceModel;
+    fillSourceModel(sourceModel, collections);
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+    addPersons(reparentingModel, collections);
+
+    QBENCHMARK {
+        reparentingModel.setSourceModel(&sourceModel);
+    }
+    QCOMPARE(reparentingModel.rowCount(QModelIndex()), resourceCount + personCount(collections));
+}
+
+void ReparentingModelBenchmark::benchmarkInsert_data()
+{
+    sizes();
+}
+
+void ReparentingModelBenchmark::benchmarkInsert()
+{
+    QFETCH(int, collections);
+    QStandardItemModel sourceModel;
+    fillSourceModel(sourceModel, collections);
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+    addPersons(reparentingModel, collections);
+
+    //A new resource with all its collections, inserted with a single signal
+    const int persons = personCount(collections);
+    QList<QStandardItem *> items;
+    for (int c = 0; c < collections; ++c) {
+        items << createCollection(c, persons);
+    }
+    QStandardItem *resource = new QStandardItem(QStringLiteral("new resource"));
+    sourceModel.appendRow(resource);
+    QBENCHMARK_ONCE {
+        resource->appendRows(items);
+    }
+}
+
+void ReparentingModelBenchmark::benchmarkRemove_data()
+{
+    sizes();
+}
+
+void ReparentingModelBenchmark::benchmarkRemove()
+{
+    QFETCH(int, collections);
+    QStandardItemModel sourceModel;
+    fillSourceModel(sourceModel, collections);
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+    addPersons(reparentingModel, collections);
+
+    QBENCHMARK_ONCE {
+        sourceModel.removeRows(0, sourceModel.rowCount());
+    }
+    QCOMPARE(reparentingModel.rowCount(QModelIndex()), personCount(collections));
+}
+
+void ReparentingModelBenchmark::benchmarkMapFromSource_data()
+{
+    sizes();
+}
+
+void ReparentingModelBenchmark::benchmarkMapFromSource()
+{
+    QFETCH(int, collections);
+    QStandardItemModel sourceModel;
+    fillSourceModel(sourceModel, collections);
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+    addPersons(reparentingModel, collections);
+
+    QModelIndexList sourceIndexes;
+    collectSourceIndexes(sourceModel, QModelIndex(), sourceIndexes);
+    QBENCHMARK {
+        for (const QModelIndex &sourceIndex : qAsConst(sourceIndexes)) {
+            reparentingModel.mapFromSource(sourceIndex);
+        }
+    }
+}
+
+void ReparentingModelBenchmark::benchmarkIndexParentWalk_data()
+{
+    sizes();
+}
+
+void ReparentingModelBenchmark::benchmarkIndexParentWalk()
+{
+    QFETCH(int, collections);
+    QStandardItemModel sourceModel;
+    fillSourceModel(sourceModel, collections);
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+    addPersons(reparentingModel, collections);
+
+    int count = 0;
+    QBENCHMARK {
+        count = walk(reparentingModel, QModelIndex());
+    }
+    QCOMPARE(count, resourceCount + personCount(collections) + collections);
+}
+
+void ReparentingModelBenchmark::benchmarkCheckState_data()
+{
+    sizes();
+}
+
+void ReparentingModelBenchmark::benchmarkCheckState()
+{
+    QFETCH(int, collections);
+    QStandardItemModel sourceModel;
+    fillSourceModel(sourceModel, collections);
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+    addPersons(reparentingModel, collections);
+    CalendarDelegateModel delegateModel;
+    delegateModel.setSourceModel(&reparentingModel);
+
+    //What the delegate asks for while painting the person nodes, answered from the cache
+    //after the first iteration
+    QBENCHMARK {
+        queryCheckStates(delegateModel);
+    }
+}
+
+void ReparentingModelBenchmark::benchmarkCheckStateCold_data()
+{
+    sizes();
+}
+
+void ReparentingModelBenchmark::benchmarkCheckStateCold()
+{
+    QFETCH(int, collections);
+    QStandardItemModel sourceModel;
+    fillSourceModel(sourceModel, collections);
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+    addPersons(reparentingModel, collections);
+    CalendarDelegateModel delegateModel;
+    delegateModel.setSourceModel(&reparentingModel);
+
+    //A change of a child drops the cached state of its parent, so every iteration aggregates again
+    QModelIndexList children;
+    for (int i = 0; i < delegateModel.rowCount(QModelIndex()); ++i) {
+        const QModelIndex index = delegateModel.index(i, 0);
+        if (delegateModel.rowCount(index) > 0) {
+            children << delegateModel.index(0, 0, index);
+        }
+    }
+    QBENCHMARK {
+        for (const QModelIndex &child : qAsConst(children)) {
+            Q_EMIT delegateModel.dataChanged(child, child);
+        }
+        queryCheckStates(delegateModel);
+    }
+}
+
+QTEST_MAIN(ReparentingModelBenchmark)
+
+#include "reparentingmodelbenchmark.moc"
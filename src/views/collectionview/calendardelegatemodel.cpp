@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2014 Christian Mollekopf <mollekopf@kolabsys.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * As a special exception, permission is given to link this program
+ * with any edition of Qt, and distribute the resulting executable,
+ * without including the source code for Qt in the source distribution.
+ */
+
+#include "calendardelegatemodel.h"
+#include "controller.h"
+
+CalendarDelegateModel::CalendarDelegateModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    //The aggregated state of a person node only changes with its children
+    connect(this, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex &topLeft, const QModelIndex &) {
+        mCheckStates.remove(topLeft.parent());
+        mEnabledStates.remove(topLeft.parent());
+    });
+    connect(this, &QAbstractItemModel::rowsInserted, this, &CalendarDelegateModel::clearAggregatedStates);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &CalendarDelegateModel::clearAggregatedStates);
+    connect(this, &QAbstractItemModel::rowsMoved, this, &CalendarDelegateModel::clearAggregatedStates);
+    connect(this, &QAbstractItemModel::layoutChanged, this, &CalendarDelegateModel::clearAggregatedStates);
+    connect(this, &QAbstractItemModel::modelReset, this, &CalendarDelegateModel::clearAggregatedStates);
+}
+
+Qt::CheckState CalendarDelegateModel::checkChildren(const QModelIndex &index, int role) const
+{
+    const QModelIndex sourceIndex = mapToSource(index);
+    bool allChecked = true;
+    bool allUnchecked = true;
+    const int count = sourceModel()->rowCount(sourceIndex);
+    for (int i = 0; i < count && (allChecked || allUnchecked); ++i) {
+        const QVariant state = sourceModel()->index(i, 0, sourceIndex).data(role);
+        allChecked = allChecked && state.isValid() && state.toInt() == Qt::Checked;
+        allUnchecked = allUnchecked && state.isValid() && state.toInt() == Qt::Unchecked;
+    }
+    if (allChecked) {
+        return Qt::Checked;
+    } else if (allUnchecked) {
+        return Qt::Unchecked;
+    } else {
+        return Qt::PartiallyChecked;
+    }
+}
+
+Qt::CheckState CalendarDelegateModel::aggregatedState(const QModelIndex &index, int role) const
+{
+    QHash<QModelIndex, Qt::CheckState> &cache = (role == EnabledRole) ? mEnabledStates : mCheckStates;
+    QHash<QModelIndex, Qt::CheckState>::const_iterator it = cache.constFind(index);
+    if (it == cache.constEnd()) {
+        it = cache.insert(index, checkChildren(index, role));
+    }
+    // qCDebug(KORGANIZER_LOG) << "person node " << index.data().toString() << it.value();
+    return it.value();
+}
+
+QVariant CalendarDelegateModel::data(const QModelIndex &index, int role) const
+{
+    if (role == Qt::CheckStateRole || role == EnabledRole) {
+        if (sourceModel()->hasChildren(mapToSource(index))
+            && index.data(NodeTypeRole).toInt() == PersonNodeRole) {
+            return aggregatedState(index, role);
+        }
+    }
+
+    return QSortFilterProxyModel::data(index, role);
+}
+
+void CalendarDelegateModel::setChildren(const QModelIndex &sourceIndex, const QVariant &value,
+                                        int role) const
+{
+    if (!sourceIndex.isValid()) {
+        return;
+    }
+    for (int i = 0; i < sourceModel()->rowCount(sourceIndex); ++i) {
+        const QModelIndex child = sourceModel()->index(i, 0, sourceIndex);
+        sourceModel()->setData(child, value, role);
+        setChildren(child, value, role);
+    }
+}
+
+bool CalendarDelegateModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (role == Qt::CheckStateRole) {
+        if (sourceModel()->hasChildren(mapToSource(index))
+            && index.data(NodeTypeRole).toInt() == PersonNodeRole) {
+            setChildren(mapToSource(index), value, role);
+        }
+    }
+    return QSortFilterProxyModel::setData(index, value, role);
+}
+
+void CalendarDelegateModel::clearAggregatedStates()
+{
+    mCheckStates.clear();
+    mEnabledStates.clear();
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2014 Christian Mollekopf <mollekopf@kolabsys.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * As a special exception, permission is given to link this program
+ * with any edition of Qt, and distribute the resulting executable,
+ * without including the source code for Qt in the source distribution.
+ */
+
+#ifndef KORG_CALENDARDELEGATEMODEL_H
+#define KORG_CALENDARDELEGATEMODEL_H
+
+#include <QHash>
+#include <QSortFilterProxyModel>
+
+/**
+ * Aggregates the check and enabled state of the children of person nodes,
+ * and forwards check state changes of a person node to its children.
+ */
+class CalendarDelegateModel : public QSortFilterProxyModel
+{
+public:
+    explicit CalendarDelegateModel(QObject *parent = nullptr);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+
+private:
+    Qt::CheckState checkChildren(const QModelIndex &index, int role) const;
+    Qt::CheckState aggregatedState(const QModelIndex &index, int role) const;
+    void setChildren(const QModelIndex &sourceIndex, const QVariant &value, int role) const;
+    void clearAggregatedStates();
+
+    //Aggregated check states of the person nodes, computed on first use
+    mutable QHash<QModelIndex, Qt::CheckState> mCheckStates;
+    mutable QHash<QModelIndex, Qt::CheckState> mEnabledStates;
+};
+
+#endif
@@ -41,6 +41,24 @@
 #include <KLocalizedString>
 
 #include <QIcon>
+#include <QTimer>
+
+//Delay between the last keystroke and the start of a search
+static const int searchDelay = 300;
+static const int searchCacheSize = 20;
+
+static bool personMatches(const KPIM::Person &person, const QString &searchString)
+{
+    return person.name.contains(searchString, Qt::CaseInsensitive)
+           || person.mail.contains(searchString, Qt::CaseInsensitive)
+           || person.uid.contains(searchString, Qt::CaseInsensitive);
+}
+
+static bool collectionMatches(const Akonadi::Collection &collection, const QString &searchString)
+{
+    return collection.name().contains(searchString, Qt::CaseInsensitive)
+           || collection.displayName().contains(searchString, Qt::CaseInsensitive);
+}
 
 CollectionNode::CollectionNode(ReparentingModel &personModel, const Akonadi::Collection &col)
     : Node(personModel)
@@ -124,6 +142,7 @@ PersonNode::PersonNode(ReparentingModel &personModel, const KPIM::Person &person
     , mPerson(person)
     , mCheckState(Qt::Unchecked)
 {
+    updateAdoptionLookup();
 }
 
 PersonNode::~PersonNode()
@@ -202,21 +221,34 @@ bool PersonNode::setData(const QVariant &value, int role)
     return false;
 }
 
-bool PersonNode::adopts(const QModelIndex &sourceIndex)
+void PersonNode::updateAdoptionLookup()
 {
-    const Akonadi::Collection &parent = sourceIndex.data(
-        Akonadi::EntityTreeModel::ParentCollectionRole).value<Akonadi::Collection>();
-    if (parent.id() == mPerson.rootCollection) {
-        return true;
+    mAdoptedCollections.clear();
+    mAdoptedCollections.reserve(mPerson.collections.size());
+    for (const Akonadi::Collection::Id id : qAsConst(mPerson.collections)) {
+        mAdoptedCollections.insert(id);
+    }
+    mAdoptedFolderPaths.clear();
+    mAdoptedFolderPaths.reserve(mPerson.folderPaths.size());
+    for (const QString &path : qAsConst(mPerson.folderPaths)) {
+        mAdoptedFolderPaths.insert(path);
     }
+}
 
+bool PersonNode::adopts(const QModelIndex &sourceIndex)
+{
     const Akonadi::Collection &col
         = sourceIndex.data(Akonadi::EntityTreeModel::CollectionRole).value<Akonadi::Collection>();
+    //The ETM hands out the parent collection of the collection for ParentCollectionRole
+    if (col.parentCollection().id() == mPerson.rootCollection) {
+        return true;
+    }
+
     // qCDebug(KORGANIZER_LOG) << col.displayName();
     //FIXME: we need a way to compare the path we get from LDAP to the folder in akonadi.
     //TODO: get it from the folder attribute
-    if ((col.isValid() && mPerson.folderPaths.contains(col.displayName()))
-        || mPerson.collections.contains(col.id())) {
+    if (mAdoptedCollections.contains(col.id())
+        || (col.isValid() && !mAdoptedFolderPaths.isEmpty() && mAdoptedFolderPaths.contains(col.displayName()))) {
         // qCDebug(KORGANIZER_LOG) << "reparenting " << col.displayName() << " to " << mPerson.name;
         return true;
     }
@@ -231,6 +263,7 @@ bool PersonNode::isDuplicateOf(const QModelIndex &sourceIndex)
 void PersonNode::update(const Node::Ptr &node)
 {
     mPerson = node.staticCast<PersonNode>()->mPerson;
+    updateAdoptionLookup();
 }
 
 KPIM::Person PersonNodeManager::person(const QModelIndex &sourceIndex)
@@ -283,11 +316,17 @@ Controller::Controller(ReparentingModel *personModel, ReparentingModel *searchMo
     , mSearchModel(searchModel)
     , mCollectionSearchJob(nullptr)
     , mPersonSearchJob(nullptr)
+    , mSearchCache(searchCacheSize)
 {
     Akonadi::AttributeFactory::registerAttribute<Akonadi::CollectionIdentificationAttribute>();
+
+    mSearchTimer = new QTimer(this);
+    mSearchTimer->setSingleShot(true);
+    mSearchTimer->setInterval(searchDelay);
+    connect(mSearchTimer, &QTimer::timeout, this, &Controller::startSearch);
 }
 
-void Controller::setSearchString(const QString &searchString)
+void Controller::abortSearch()
 {
     if (mCollectionSearchJob) {
         disconnect(mCollectionSearchJob, nullptr, this, nullptr);
@@ -299,18 +338,71 @@ void Controller::setSearchString(const QString &searchString)
         mPersonSearchJob->kill(KJob::Quietly);
         mPersonSearchJob = nullptr;
     }
-    //TODO: Delay and abort when results are found
-    mSearchModel->clear();
+}
+
+void Controller::setSearchString(const QString &searchString)
+{
+    mSearchTimer->stop();
+    abortSearch();
     Q_EMIT searchIsActive(!searchString.isEmpty());
     const bool showAllPersonalFolders = (searchString == QLatin1String("*"));
     if (searchString.size() < 2 && !showAllPersonalFolders) {
+        mSearchString.clear();
+        mSearchModel->clear();
         Q_EMIT searching(false);
         return;
     }
+    //Only search once the user stopped typing
+    mSearchString = searchString;
+    mSearchTimer->start();
+}
 
-    if (!showAllPersonalFolders) {
-        Q_EMIT searching(true);
+const Controller::SearchResult *Controller::cachedSearchResult(const QString &searchString)
+{
+    if (const SearchResult *result = mSearchCache.object(searchString)) {
+        return result;
+    }
+    //The results of a longer search string are a subset of those of its prefixes,
+    //so narrow down the results of the longest prefix we still know about.
+    for (int length = searchString.size() - 1; length >= 2; --length) {
+        const SearchResult *prefixResult = mSearchCache.object(searchString.left(length));
+        if (!prefixResult) {
+            continue;
+        }
+        SearchResult *result = new SearchResult;
+        for (const KPIM::Person &person : prefixResult->persons) {
+            if (personMatches(person, searchString)) {
+                result->persons << person;
+            }
+        }
+        for (const Akonadi::Collection &collection : prefixResult->collections) {
+            if (collectionMatches(collection, searchString)) {
+                result->collections << collection;
+            }
+        }
+        mSearchCache.insert(searchString, result);
+        return mSearchCache.object(searchString);
+    }
+    return nullptr;
+}
+
+void Controller::startSearch()
+{
+    const QString searchString = mSearchString;
+    abortSearch();
+    mSearchModel->clear();
+    mSearchResult = SearchResult();
+    mSearchFailed = false;
+
+    if (const SearchResult *result = cachedSearchResult(searchString)) {
+        addSearchNodes(result->persons, result->collections);
+        Q_EMIT searching(false);
+        return;
+    }
 
+    Q_EMIT searching(true);
+    const bool showAllPersonalFolders = (searchString == QLatin1String("*"));
+    if (!showAllPersonalFolders) {
         mPersonSearchJob = new KPIM::PersonSearchJob(searchString, this);
         connect(mPersonSearchJob, &KPIM::PersonSearchJob::personsFound,
                 this,
@@ -331,39 +423,68 @@ void Controller::setSearchString(const QString &searchString)
     mCollectionSearchJob->start();
 }
 
-void Controller::onCollectionsFound(KJob *job)
+void Controller::searchJobFinished()
 {
-    mCollectionSearchJob = nullptr;
-    if (!mPersonSearchJob) {
-        Q_EMIT searching(false);
-    }
-    if (job->error()) {
-        qCWarning(KORGANIZER_LOG) << job->errorString();
+    if (mCollectionSearchJob || mPersonSearchJob) {
         return;
     }
-    Q_FOREACH (const Akonadi::Collection &col,
-               static_cast<KPIM::CollectionSearchJob *>(job)->matchingCollections()) {
-        CollectionNode *collectionNode = new CollectionNode(*mSearchModel, col);
-        collectionNode->isSearchNode = true;
-        //toggled by the checkbox, results in collection getting monitored
-        // connect(&collectionNode->emitter, SIGNAL(enabled(bool,Akonadi::Collection)), this, SLOT(onCollectionEnabled(bool,Akonadi::Collection)));
-        mSearchModel->addNode(ReparentingModel::Node::Ptr(collectionNode));
+    Q_EMIT searching(false);
+    if (!mSearchFailed) {
+        mSearchCache.insert(mSearchString, new SearchResult(mSearchResult));
     }
 }
 
-void Controller::onPersonsFound(const QVector<KPIM::Person> &persons)
+void Controller::addSearchNodes(const QVector<KPIM::Person> &persons,
+                                const Akonadi::Collection::List &collections)
 {
+    QVector<ReparentingModel::Node::Ptr> nodes;
+    nodes.reserve(persons.size() + collections.size());
     for (const KPIM::Person &p : persons) {
         PersonNode *personNode = new PersonNode(*mSearchModel, p);
         personNode->isSearchNode = true;
         //toggled by the checkbox, results in person getting added to main model
         // connect(&personNode->emitter, SIGNAL(enabled(bool,Person)), this, SLOT(onPersonEnabled(bool,Person)));
-        mSearchModel->addNode(ReparentingModel::Node::Ptr(personNode));
+        nodes << ReparentingModel::Node::Ptr(personNode);
+    }
+    for (const Akonadi::Collection &col : collections) {
+        CollectionNode *collectionNode = new CollectionNode(*mSearchModel, col);
+        collectionNode->isSearchNode = true;
+        //toggled by the checkbox, results in collection getting monitored
+        // connect(&collectionNode->emitter, SIGNAL(enabled(bool,Akonadi::Collection)), this, SLOT(onCollectionEnabled(bool,Akonadi::Collection)));
+        nodes << ReparentingModel::Node::Ptr(collectionNode);
     }
+    mSearchModel->addNodes(nodes);
+}
+
+void Controller::onCollectionsFound(KJob *job)
+{
+    mCollectionSearchJob = nullptr;
+    if (job->error()) {
+        qCWarning(KORGANIZER_LOG) << job->errorString();
+        mSearchFailed = true;
+        searchJobFinished();
+        return;
+    }
+    const Akonadi::Collection::List collections
+        = static_cast<KPIM::CollectionSearchJob *>(job)->matchingCollections();
+    mSearchResult.collections = collections;
+    addSearchNodes(QVector<KPIM::Person>(), collections);
+    searchJobFinished();
+}
+
+void Controller::onPersonsFound(const QVector<KPIM::Person> &persons)
+{
+    mSearchResult.persons += persons;
+    addSearchNodes(persons, Akonadi::Collection::List());
 }
 
 void Controller::onPersonUpdate(const KPIM::Person &person)
 {
+    for (KPIM::Person &p : mSearchResult.persons) {
+        if (p.uid == person.uid) {
+            p = person;
+        }
+    }
     PersonNode *personNode = new PersonNode(*mSearchModel, person);
     personNode->isSearchNode = true;
     mSearchModel->updateNode(ReparentingModel::Node::Ptr(personNode));
@@ -372,13 +493,11 @@ void Controller::onPersonUpdate(const KPIM::Person &person)
 void Controller::onPersonsFound(KJob *job)
 {
     mPersonSearchJob = nullptr;
-    if (!mCollectionSearchJob) {
-        Q_EMIT searching(false);
-    }
     if (job->error()) {
         qCWarning(KORGANIZER_LOG) << job->errorString();
-        return;
+        mSearchFailed = true;
     }
+    searchJobFinished();
 }
 
 static Akonadi::EntityTreeModel *findEtm(QAbstractItemModel *model)
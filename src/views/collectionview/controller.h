@@ -23,7 +23,9 @@
 #ifndef KORG_CONTROLLER_H
 #define KORG_CONTROLLER_H
 
+#include <QCache>
 #include <QObject>
+#include <QSet>
 #include <AkonadiCore/EntityTreeModel>
 #include <AkonadiCore/Collection>
 #include "reparentingmodel.h"
@@ -89,9 +91,13 @@ private:
     bool adopts(const QModelIndex &sourceIndex) override;
     bool isDuplicateOf(const QModelIndex &sourceIndex) override;
     void update(const Node::Ptr &node) override;
+    void updateAdoptionLookup();
 
     KPIM::Person mPerson;
     Qt::CheckState mCheckState;
+    //Lookup of the collections adopted by this person, adopts() is asked for every collection in the ETM
+    QSet<Akonadi::Collection::Id> mAdoptedCollections;
+    QSet<QString> mAdoptedFolderPaths;
 };
 
 class CollectionNode : public ReparentingModel::Node
@@ -131,6 +137,8 @@ class CollectionSearchJob;
 class PersonSearchJob;
 }
 
+class QTimer;
+
 /**
  * Add search results to the search model, and use the selection to add results to the person model.
  */
@@ -169,12 +177,31 @@ private Q_SLOTS:
     void onPersonUpdate(const KPIM::Person &person);
     void onPersonsFound(KJob *job);
     void onPersonCollectionsFetched(KJob *job);
+    void startSearch();
 
 private:
+    struct SearchResult {
+        QVector<KPIM::Person> persons;
+        Akonadi::Collection::List collections;
+    };
+
+    void abortSearch();
+    void searchJobFinished();
+    const SearchResult *cachedSearchResult(const QString &searchString);
+    void addSearchNodes(const QVector<KPIM::Person> &persons,
+                        const Akonadi::Collection::List &collections);
+
     ReparentingModel *mPersonModel = nullptr;
     ReparentingModel *mSearchModel = nullptr;
     KPIM::CollectionSearchJob *mCollectionSearchJob = nullptr;
     KPIM::PersonSearchJob *mPersonSearchJob = nullptr;
+    QTimer *mSearchTimer = nullptr;
+    QString mSearchString;
+    //Results of the running search, cached once both jobs succeeded
+    SearchResult mSearchResult;
+    bool mSearchFailed = false;
+    //Recent search results by search string
+    QCache<QString, SearchResult> mSearchCache;
 };
 
 #endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2014  Sandro Knauß <knauss@kolabsys.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * As a special exception, permission is given to link this program
+ * with any edition of Qt, and distribute the resulting executable,
+ * without including the source code for Qt in the source distribution.
+ */
+
+#include "freebusycache.h"
+
+#include <KCalCore/FreeBusy>
+
+#include <CalendarSupport/FreeBusyCalendar>
+
+#include <KLocalizedString>
+
+#include <QCoreApplication>
+
+FreebusyViewCalendar::~FreebusyViewCalendar()
+{
+    if (mCalendar) {
+        mCalendar->unregisterObserver(this);
+    }
+}
+
+void FreebusyViewCalendar::setCalendar(const KCalCore::Calendar::Ptr &calendar)
+{
+    if (mCalendar) {
+        mCalendar->unregisterObserver(this);
+    }
+    mCalendar = calendar;
+    mColors.clear();
+    if (mCalendar) {
+        mCalendar->registerObserver(this);
+    }
+}
+
+bool FreebusyViewCalendar::isValid(const KCalCore::Incidence::Ptr &incidence) const
+{
+    return isValid(incidence->uid());
+}
+
+bool FreebusyViewCalendar::isValid(const QString &incidenceIdentifier) const
+{
+    return incidenceIdentifier.startsWith(QLatin1String("fb-"));
+}
+
+QString FreebusyViewCalendar::displayName(const KCalCore::Incidence::Ptr &incidence) const
+{
+    Q_UNUSED(incidence);
+    return i18n("Free/Busy calendar from %1", name);
+}
+
+QColor FreebusyViewCalendar::resourceColor(const KCalCore::Incidence::Ptr &incidence) const
+{
+    //The status is parsed once per free/busy period, not on every paint
+    QHash<QString, QColor>::const_iterator it = mColors.constFind(incidence->uid());
+    if (it == mColors.constEnd()) {
+        it = mColors.insert(incidence->uid(), statusColor(incidence));
+    }
+    return it.value();
+}
+
+QString FreebusyViewCalendar::iconForIncidence(const KCalCore::Incidence::Ptr &incidence) const
+{
+    Q_UNUSED(incidence);
+    return QString();
+}
+
+KCalCore::Calendar::Ptr FreebusyViewCalendar::getCalendar() const
+{
+    return mCalendar;
+}
+
+void FreebusyViewCalendar::calendarIncidenceAdded(const KCalCore::Incidence::Ptr &incidence)
+{
+    mColors.remove(incidence->uid());
+}
+
+void FreebusyViewCalendar::calendarIncidenceChanged(const KCalCore::Incidence::Ptr &incidence)
+{
+    mColors.remove(incidence->uid());
+}
+
+void FreebusyViewCalendar::calendarIncidenceDeleted(const KCalCore::Incidence::Ptr &incidence,
+                                                    const KCalCore::Calendar *calendar)
+{
+    Q_UNUSED(calendar);
+    mColors.remove(incidence->uid());
+}
+
+QColor FreebusyViewCalendar::statusColor(const KCalCore::Incidence::Ptr &incidence)
+{
+    bool ok = false;
+    int status = incidence->customProperty(QStringLiteral(
+                                               "FREEBUSY").toLatin1(), QStringLiteral(
+                                               "STATUS").toLatin1()).toInt(&ok);
+
+    if (!ok) {
+        return QColor(85, 85, 85);
+    }
+
+    switch (status) {
+    case KCalCore::FreeBusyPeriod::Busy:
+        return QColor(255, 0, 0);
+    case KCalCore::FreeBusyPeriod::BusyTentative:
+    case KCalCore::FreeBusyPeriod::BusyUnavailable:
+        return QColor(255, 119, 0);
+    case KCalCore::FreeBusyPeriod::Free:
+        return QColor(0, 255, 0);
+    default:
+        return QColor(85, 85, 85);
+    }
+}
+
+FreeBusyData::FreeBusyData(const KCalCore::Calendar::Ptr &calendar)
+    : QObject(QCoreApplication::instance())
+    , calendar(calendar)
+{
+}
+
+static FreeBusyData *downloadFreeBusy(const KCalCore::Attendee::Ptr &attendee)
+{
+    CalendarSupport::FreeBusyCalendar *fbCalendar = new CalendarSupport::FreeBusyCalendar();
+    FreeBusyData *data = new FreeBusyData(fbCalendar->calendar());
+    fbCalendar->setParent(data);
+
+    CalendarSupport::FreeBusyItemModel *model = new CalendarSupport::FreeBusyItemModel(data);
+    fbCalendar->setModel(model);
+    model->addItem(CalendarSupport::FreeBusyItem::Ptr(new CalendarSupport::FreeBusyItem(attendee,
+                                                                                       nullptr)));
+    return data;
+}
+
+Q_GLOBAL_STATIC(FreeBusyCache, sFreeBusyCache)
+
+FreeBusyCache::FreeBusyCache()
+    : mFactory(downloadFreeBusy)
+{
+}
+
+FreeBusyCache::FreeBusyCache(const Factory &factory)
+    : mFactory(factory)
+{
+}
+
+FreeBusyCache::~FreeBusyCache()
+{
+    for (const QPointer<FreeBusyData> &data : qAsConst(mData)) {
+        delete data.data();
+    }
+}
+
+FreeBusyCache *FreeBusyCache::self()
+{
+    return sFreeBusyCache;
+}
+
+FreeBusyData *FreeBusyCache::data(const KCalCore::Attendee::Ptr &attendee, const QDateTime &now)
+{
+    auto it = mData.begin();
+    while (it != mData.end()) {
+        if (!it.value() || it.value()->created.secsTo(now) > ExpirySecs) {
+            //Quickviews still showing the expired data keep their calendar pointer
+            if (it.value()) {
+                it.value()->deleteLater();
+            }
+            it = mData.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const QString key = attendee->email().toLower();
+    FreeBusyData *data = mData.value(key);
+    if (!data) {
+        data = mFactory(attendee);
+        data->created = now;
+        mData.insert(key, data);
+    }
+    return data;
+}
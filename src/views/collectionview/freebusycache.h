@@ -0,0 +1,130 @@
+/*
+ * Copyright 2014  Sandro Knauß <knauss@kolabsys.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * As a special exception, permission is given to link this program
+ * with any edition of Qt, and distribute the resulting executable,
+ * without including the source code for Qt in the source distribution.
+ */
+
+#ifndef KORG_FREEBUSYCACHE_H
+#define KORG_FREEBUSYCACHE_H
+
+#include <EventViews/ViewCalendar>
+
+#include <KCalCore/Attendee>
+#include <KCalCore/Calendar>
+
+#include <QColor>
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+
+#include <functional>
+
+/**
+ * Shows the free/busy periods of an attendee in the agenda view of a quickview,
+ * colored by their status.
+ *
+ * The status is parsed once per period, the colors are cached until the period
+ * changes in the calendar.
+ */
+class FreebusyViewCalendar : public EventViews::ViewCalendar,
+    public KCalCore::Calendar::CalendarObserver
+{
+public:
+    ~FreebusyViewCalendar() override;
+
+    void setCalendar(const KCalCore::Calendar::Ptr &calendar);
+
+    bool isValid(const KCalCore::Incidence::Ptr &incidence) const override;
+    bool isValid(const QString &incidenceIdentifier) const override;
+    QString displayName(const KCalCore::Incidence::Ptr &incidence) const override;
+    QColor resourceColor(const KCalCore::Incidence::Ptr &incidence) const override;
+    QString iconForIncidence(const KCalCore::Incidence::Ptr &incidence) const override;
+    KCalCore::Calendar::Ptr getCalendar() const override;
+
+    void calendarIncidenceAdded(const KCalCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceChanged(const KCalCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceDeleted(const KCalCore::Incidence::Ptr &incidence,
+                                  const KCalCore::Calendar *calendar) override;
+
+    QString name;
+
+private:
+    static QColor statusColor(const KCalCore::Incidence::Ptr &incidence);
+
+    KCalCore::Calendar::Ptr mCalendar;
+    mutable QHash<QString, QColor> mColors;
+};
+
+/**
+ * The free/busy data of one attendee. The children of this object fill the
+ * calendar while the data is downloaded.
+ */
+class FreeBusyData : public QObject
+{
+public:
+    explicit FreeBusyData(const KCalCore::Calendar::Ptr &calendar);
+
+    KCalCore::Calendar::Ptr calendar;
+    QDateTime created;
+};
+
+/**
+ * The free/busy data of the attendees shown by quickviews.
+ *
+ * The data of an attendee is shared by all quickviews of the attendee, including
+ * the ones opened while the download is still running, and kept around for a while
+ * after they were closed.
+ */
+class FreeBusyCache
+{
+public:
+    /**
+     * Creates the data of an attendee and starts filling it.
+     */
+    typedef std::function<FreeBusyData *(const KCalCore::Attendee::Ptr &attendee)> Factory;
+
+    //Free/busy data is downloaded again once it is older than this
+    static const int ExpirySecs = 15 * 60;
+
+    /**
+     * Creates a cache which downloads the data with the free/busy manager.
+     */
+    FreeBusyCache();
+    explicit FreeBusyCache(const Factory &factory);
+    ~FreeBusyCache();
+
+    /**
+     * The cache used by the quickviews.
+     */
+    static FreeBusyCache *self();
+
+    /**
+     * Returns the data of @p attendee, creating it if there is none younger than
+     * ExpirySecs at @p now. E-mail addresses differing in case share their data.
+     */
+    FreeBusyData *data(const KCalCore::Attendee::Ptr &attendee,
+                       const QDateTime &now = QDateTime::currentDateTimeUtc());
+
+private:
+    Factory mFactory;
+    QHash<QString, QPointer<FreeBusyData> > mData;
+};
+
+#endif
@@ -22,6 +22,8 @@
 
 #include "quickview.h"
 #include "ui_quickview.h"
+#include "freebusycache.h"
+#include "kohelper.h"
 #include "korganizer_debug.h"
 
 #include <AkonadiCore/entitydisplayattribute.h>
@@ -31,67 +33,76 @@
 #include <KCalCore/Event>
 #include <KCalCore/FreeBusy>
 #include <KCalCore/MemoryCalendar>
+#include <KCalCore/Todo>
 
 #include <EventViews/AgendaView>
 #include <EventViews/ViewCalendar>
 
-#include <CalendarSupport/FreeBusyCalendar>
 #include <CalendarSupport/Utils>
 
 #include <KCheckableProxyModel>
 #include <KConfigGroup>
 #include <KSharedConfig>
 
+#include <QCoreApplication>
+#include <QDateTime>
 #include <QDialogButtonBox>
+#include <QHash>
+#include <QPointer>
 #include <QPushButton>
 #include <QSplitter>
+#include <QTimer>
 #include <QVBoxLayout>
 
-class FreebusyViewCalendar : public EventViews::ViewCalendar
+/**
+ * The events and to-dos of a collection the main calendar has loaded already, so
+ * that a quickview of it doesn't fetch the collection again.
+ *
+ * The incidences are copied into a calendar of their own, the main calendar shows
+ * other collections as well. The copies follow the changes of the main calendar.
+ */
+class CollectionViewCalendar : public EventViews::ViewCalendar,
+    public KCalCore::Calendar::CalendarObserver
 {
 public:
-    ~FreebusyViewCalendar() override
+    CollectionViewCalendar(const Akonadi::ETMCalendar::Ptr &mainCalendar,
+                           const Akonadi::Collection &collection,
+                           const Akonadi::Item::List &items)
+        : mMainCalendar(mainCalendar)
+        , mCollection(collection)
+        , mCalendar(new KCalCore::MemoryCalendar(mainCalendar->timeZone()))
     {
+        for (const Akonadi::Item &item : items) {
+            addCopy(CalendarSupport::incidence(item));
+        }
+        mMainCalendar->registerObserver(this);
+    }
+
+    ~CollectionViewCalendar() override
+    {
+        mMainCalendar->unregisterObserver(this);
     }
 
     bool isValid(const KCalCore::Incidence::Ptr &incidence) const override
     {
-        return isValid(incidence->uid());
+        return mCalendar->incidence(incidence->uid(), incidence->recurrenceId());
     }
 
     bool isValid(const QString &incidenceIdentifier) const override
     {
-        return incidenceIdentifier.startsWith(QLatin1String("fb-"));
+        return mCalendar->incidence(incidenceIdentifier);
     }
 
     QString displayName(const KCalCore::Incidence::Ptr &incidence) const override
     {
         Q_UNUSED(incidence);
-        return i18n("Free/Busy calendar from %1", name);
+        return CalendarSupport::displayName(mMainCalendar.data(), mCollection);
     }
 
     QColor resourceColor(const KCalCore::Incidence::Ptr &incidence) const override
     {
-        bool ok = false;
-        int status = incidence->customProperty(QStringLiteral(
-                                                   "FREEBUSY").toLatin1(), QStringLiteral(
-                                                   "STATUS").toLatin1()).toInt(&ok);
-
-        if (!ok) {
-            return QColor(85, 85, 85);
-        }
-
-        switch (status) {
-        case KCalCore::FreeBusyPeriod::Busy:
-            return QColor(255, 0, 0);
-        case KCalCore::FreeBusyPeriod::BusyTentative:
-        case KCalCore::FreeBusyPeriod::BusyUnavailable:
-            return QColor(255, 119, 0);
-        case KCalCore::FreeBusyPeriod::Free:
-            return QColor(0, 255, 0);
-        default:
-            return QColor(85, 85, 85);
-        }
+        Q_UNUSED(incidence);
+        return KOHelper::resourceColor(mCollection);
     }
 
     QString iconForIncidence(const KCalCore::Incidence::Ptr &incidence) const override
@@ -105,11 +116,197 @@ public:
         return mCalendar;
     }
 
-    KCalCore::Calendar::Ptr mCalendar;
-    QString name;
+    void calendarIncidenceAdded(const KCalCore::Incidence::Ptr &incidence) override
+    {
+        if (belongsToCollection(incidence)) {
+            addCopy(incidence);
+        }
+    }
+
+    void calendarIncidenceChanged(const KCalCore::Incidence::Ptr &incidence) override
+    {
+        //Also drops incidences moved to another collection
+        removeCopy(incidence);
+        if (belongsToCollection(incidence)) {
+            addCopy(incidence);
+        }
+    }
+
+    void calendarIncidenceDeleted(const KCalCore::Incidence::Ptr &incidence,
+                                  const KCalCore::Calendar *calendar) override
+    {
+        Q_UNUSED(calendar);
+        removeCopy(incidence);
+    }
+
+private:
+    bool belongsToCollection(const KCalCore::Incidence::Ptr &incidence) const
+    {
+        return mMainCalendar->item(incidence).parentCollection().id() == mCollection.id();
+    }
+
+    void addCopy(const KCalCore::Incidence::Ptr &incidence)
+    {
+        //The agenda view only shows events and to-dos
+        if (incidence
+            && (incidence->type() == KCalCore::Incidence::TypeEvent
+                || incidence->type() == KCalCore::Incidence::TypeTodo)) {
+            mCalendar->addIncidence(KCalCore::Incidence::Ptr(incidence->clone()));
+        }
+    }
+
+    void removeCopy(const KCalCore::Incidence::Ptr &incidence)
+    {
+        const KCalCore::Incidence::Ptr copy
+            = mCalendar->incidence(incidence->uid(), incidence->recurrenceId());
+        if (copy) {
+            mCalendar->deleteIncidence(copy);
+        }
+    }
+
+    Akonadi::ETMCalendar::Ptr mMainCalendar;
+    Akonadi::Collection mCollection;
+    KCalCore::MemoryCalendar::Ptr mCalendar;
 };
 
-Quickview::Quickview(const KPIM::Person &person, const Akonadi::Collection &col)
+/**
+ * The calendars fetched for quickviews of collections the main calendar hasn't loaded.
+ *
+ * Quickviews of one collection share its calendar. The last few calendars stay
+ * loaded for a while after their quickviews were closed, so that opening one of
+ * them again doesn't fetch the whole collection again.
+ */
+class QuickviewCalendarCache : public QObject
+{
+public:
+    static QuickviewCalendarCache *self()
+    {
+        static QPointer<QuickviewCalendarCache> instance;
+        if (!instance) {
+            instance = new QuickviewCalendarCache();
+        }
+        return instance;
+    }
+
+    Akonadi::ETMCalendar::Ptr calendar(const Akonadi::Collection &collection)
+    {
+        Akonadi::ETMCalendar::Ptr calendar = mOpenCalendars.value(collection.id()).toStrongRef();
+        if (!calendar) {
+            calendar = createCalendar(collection);
+            mOpenCalendars.insert(collection.id(), calendar);
+        }
+        touch(collection.id(), calendar);
+        return calendar;
+    }
+
+    /**
+     * To be called when a quickview of the collection is closed, the idle time
+     * of its calendar starts again.
+     */
+    void release(Akonadi::Collection::Id id)
+    {
+        const Akonadi::ETMCalendar::Ptr calendar = mOpenCalendars.value(id).toStrongRef();
+        if (calendar) {
+            touch(id, calendar);
+        }
+    }
+
+private:
+    struct Entry {
+        Akonadi::Collection::Id id;
+        Akonadi::ETMCalendar::Ptr calendar;
+        QDateTime lastUsed;
+    };
+
+    QuickviewCalendarCache()
+        : QObject(QCoreApplication::instance())
+        , mExpiryTimer(new QTimer(this))
+    {
+        mExpiryTimer->setInterval(ExpiryCheckInterval);
+        connect(mExpiryTimer, &QTimer::timeout, this, [this]() {
+            dropExpired();
+        });
+    }
+
+    void touch(Akonadi::Collection::Id id, const Akonadi::ETMCalendar::Ptr &calendar)
+    {
+        for (int i = 0; i < mEntries.count(); ++i) {
+            if (mEntries.at(i).id == id) {
+                mEntries.remove(i);
+                break;
+            }
+        }
+        Entry entry;
+        entry.id = id;
+        entry.calendar = calendar;
+        entry.lastUsed = QDateTime::currentDateTimeUtc();
+        mEntries.prepend(entry);
+        if (mEntries.count() > Capacity) {
+            mEntries.removeLast();
+        }
+        mExpiryTimer->start();
+    }
+
+    void dropExpired()
+    {
+        //Calendars still shown by a quickview stay alive through the quickview
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        while (!mEntries.isEmpty() && mEntries.last().lastUsed.secsTo(now) > IdleExpirySecs) {
+            mEntries.removeLast();
+        }
+        for (auto it = mOpenCalendars.begin(); it != mOpenCalendars.end();) {
+            if (it.value().isNull()) {
+                it = mOpenCalendars.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (mEntries.isEmpty()) {
+            mExpiryTimer->stop();
+        }
+    }
+
+    static Akonadi::ETMCalendar::Ptr createCalendar(const Akonadi::Collection &collection)
+    {
+        Akonadi::ChangeRecorder *monitor = new Akonadi::ChangeRecorder();
+        Akonadi::ItemFetchScope scope;
+        //The agenda view only shows events and to-dos, so don't load the journals
+        const QStringList mimeTypes
+            = { KCalCore::Event::eventMimeType(), KCalCore::Todo::todoMimeType() };
+
+        scope.fetchFullPayload(true);
+        scope.fetchAttribute<Akonadi::EntityDisplayAttribute>();
+
+        monitor->setCollectionMonitored(collection);
+        monitor->fetchCollection(true);
+        monitor->setItemFetchScope(scope);
+        monitor->setAllMonitored(true);
+
+        for (const QString &mimetype : mimeTypes) {
+            monitor->setMimeTypeMonitored(mimetype, true);
+        }
+
+        Akonadi::ETMCalendar::Ptr calendar(new Akonadi::ETMCalendar(monitor));
+        //The calendar outlives the quickview that created it
+        monitor->setParent(calendar.data());
+        calendar->setCollectionFilteringEnabled(false);
+        return calendar;
+    }
+
+    //Number of calendars kept loaded without a quickview
+    static const int Capacity = 3;
+    static const int IdleExpirySecs = 10 * 60;
+    static const int ExpiryCheckInterval = 60 * 1000;
+
+    //Most recently used first
+    QVector<Entry> mEntries;
+    //Calendars of the open quickviews, including the ones which dropped out of mEntries
+    QHash<Akonadi::Collection::Id, QWeakPointer<Akonadi::ETMCalendar> > mOpenCalendars;
+    QTimer *mExpiryTimer = nullptr;
+};
+
+Quickview::Quickview(const KPIM::Person &person, const Akonadi::Collection &col,
+                     const Akonadi::ETMCalendar::Ptr &mainCalendar)
     : QDialog()
     , mUi(new Ui_quickview)
     , mPerson(person)
@@ -134,46 +331,26 @@ Quickview::Quickview(const KPIM::Person &person, const Akonadi::Collection &col)
     mUi->mDayBtn->hide();
     //show fbcalendar for person in quickview
     if (!person.mail.isEmpty()) {
-        CalendarSupport::FreeBusyItemModel *model = new CalendarSupport::FreeBusyItemModel(this);
-        CalendarSupport::FreeBusyCalendar *fbCal = new CalendarSupport::FreeBusyCalendar(this);
         FreebusyViewCalendar *fbCalendar = new FreebusyViewCalendar();
         KCalCore::Attendee::Ptr attendee(new KCalCore::Attendee(person.name, person.mail));
-        CalendarSupport::FreeBusyItem::Ptr freebusy(new CalendarSupport::FreeBusyItem(attendee,
-                                                                                      this));
-
-        fbCal->setModel(model);
-        model->addItem(freebusy);
-        fbCalendar->mCalendar = fbCal->calendar();
+        fbCalendar->setCalendar(FreeBusyCache::self()->data(attendee)->calendar);
         fbCalendar->name = attendee->fullName();
         mAgendaView->addCalendar(EventViews::ViewCalendar::Ptr(fbCalendar));
     }
 
     if (mCollection.isValid()) {
-        //create etm for mCollection
-        Akonadi::ChangeRecorder *monitor = new Akonadi::ChangeRecorder(this);
-        Akonadi::ItemFetchScope scope;
-        const QStringList allMimeTypes
-            = { KCalCore::Event::eventMimeType(), KCalCore::Todo::todoMimeType(),
-                KCalCore::Journal::journalMimeType()};
-
-        scope.fetchFullPayload(true);
-        scope.fetchAttribute<Akonadi::EntityDisplayAttribute>();
-
-        monitor->setCollectionMonitored(mCollection);
-        monitor->fetchCollection(true);
-        monitor->setItemFetchScope(scope);
-        monitor->setAllMonitored(true);
-
-        for (const QString &mimetype : allMimeTypes) {
-            monitor->setMimeTypeMonitored(mimetype, true);
+        const Akonadi::Item::List items
+            = mainCalendar ? mainCalendar->items(mCollection.id()) : Akonadi::Item::List();
+        Akonadi::ETMCalendar::Ptr calendar;
+        if (!items.isEmpty()) {
+            mAgendaView->addCalendar(EventViews::ViewCalendar::Ptr(
+                                         new CollectionViewCalendar(mainCalendar, mCollection, items)));
+            calendar = mainCalendar;
+        } else {
+            calendar = QuickviewCalendarCache::self()->calendar(mCollection);
+            mAgendaView->setCalendar(calendar);
         }
 
-        Akonadi::ETMCalendar::Ptr calendar
-            = Akonadi::ETMCalendar::Ptr(new Akonadi::ETMCalendar(monitor));
-
-        calendar->setCollectionFilteringEnabled(false);
-        mAgendaView->setCalendar(calendar);
-
         setWindowTitle(i18nc("@title:window",
                              "%1",
                              CalendarSupport::displayName(calendar.data(), mCollection)));
@@ -191,6 +368,9 @@ Quickview::Quickview(const KPIM::Person &person, const Akonadi::Collection &col)
 
 Quickview::~Quickview()
 {
+    if (mCollection.isValid()) {
+        QuickviewCalendarCache::self()->release(mCollection.id());
+    }
     writeConfig();
     delete mUi;
 }
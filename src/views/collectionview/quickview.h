@@ -27,6 +27,8 @@
 
 #include <EventViews/ViewCalendar>
 
+#include <Akonadi/Calendar/ETMCalendar>
+
 #include <KCalCore/FreeBusy>
 #include <QDialog>
 
@@ -40,7 +42,12 @@ class Quickview : public QDialog
 {
     Q_OBJECT
 public:
-    Quickview(const KPIM::Person &person, const Akonadi::Collection &col);
+    /**
+     * Shows the calendar of @p col. If @p mainCalendar has loaded the collection already,
+     * its incidences are shown from there instead of fetching the collection again.
+     */
+    Quickview(const KPIM::Person &person, const Akonadi::Collection &col,
+              const Akonadi::ETMCalendar::Ptr &mainCalendar = Akonadi::ETMCalendar::Ptr());
     ~Quickview() override;
 
 private Q_SLOTS:
@@ -24,6 +24,8 @@
 
 #include "korganizer_debug.h"
 
+#include <algorithm>
+
 /*
  * Notes:
  * * layoutChanged must never add or remove nodes.
@@ -47,6 +49,9 @@ ReparentingModel::Node::Node(ReparentingModel &model, ReparentingModel::Node *p,
 {
     if (sourceIndex.isValid()) {
         personModel.mSourceNodes.append(this);
+        if (!personModel.mSourceNodeIndexDirty) {
+            personModel.mSourceNodeByIndex.insert(sourceIndex, this);
+        }
     }
     Q_ASSERT(parent);
 }
@@ -55,6 +60,15 @@ ReparentingModel::Node::~Node()
 {
     //The source index may be invalid meanwhile (it's a persistent index)
     personModel.mSourceNodes.removeOne(this);
+    if (!mIsSourceNode || personModel.mSourceNodeIndexDirty) {
+        return;
+    }
+    QHash<QModelIndex, Node *>::iterator it = personModel.mSourceNodeByIndex.find(sourceIndex);
+    if (sourceIndex.isValid() && it != personModel.mSourceNodeByIndex.end() && it.value() == this) {
+        personModel.mSourceNodeByIndex.erase(it);
+    } else {
+        personModel.invalidateSourceNodeIndex();
+    }
 }
 
 bool ReparentingModel::Node::operator==(const ReparentingModel::Node &node) const
@@ -67,14 +81,11 @@ ReparentingModel::Node::Ptr ReparentingModel::Node::searchNode(ReparentingModel:
     Node::Ptr nodePtr;
     if (node->parent) {
         //Reparent node
-        QVector<Node::Ptr>::iterator it = node->parent->children.begin();
-        for (; it != node->parent->children.end(); ++it) {
-            if (it->data() == node) {
-                //Reuse smart pointer
-                nodePtr = *it;
-                node->parent->children.erase(it);
-                break;
-            }
+        const int row = node->row();
+        if (row >= 0) {
+            //Reuse smart pointer
+            nodePtr = node->parent->children.at(row);
+            node->parent->children.remove(row);
         }
         Q_ASSERT(nodePtr);
     } else {
@@ -93,6 +104,7 @@ void ReparentingModel::Node::reparent(ReparentingModel::Node *node)
 void ReparentingModel::Node::addChild(const ReparentingModel::Node::Ptr &node)
 {
     node->parent = this;
+    node->mRow = children.size();
     children.append(node);
 }
 
@@ -137,14 +149,23 @@ bool ReparentingModel::Node::isSourceNode() const
 int ReparentingModel::Node::row() const
 {
     Q_ASSERT(parent);
-    int row = 0;
-    for (const Node::Ptr &node : qAsConst(parent->children)) {
-        if (node.data() == this) {
-            return row;
+    const QVector<Node::Ptr> &siblings = parent->children;
+    if (mRow < 0 || mRow >= siblings.size() || siblings.at(mRow).data() != this) {
+        //Children have been inserted or removed before us since the last lookup
+        parent->renumberChildren();
+        if (mRow < 0 || mRow >= siblings.size() || siblings.at(mRow).data() != this) {
+            return -1;
         }
-        row++;
     }
-    return -1;
+    return mRow;
+}
+
+void ReparentingModel::Node::renumberChildren() const
+{
+    const int count = children.size();
+    for (int i = 0; i < count; ++i) {
+        children.at(i)->mRow = i;
+    }
 }
 
 ReparentingModel::ReparentingModel(QObject *parent)
@@ -160,6 +181,7 @@ ReparentingModel::~ReparentingModel()
     mRootNode.children.clear();
     mProxyNodes.clear();
     mSourceNodes.clear();
+    mSourceNodeByIndex.clear();
 }
 
 bool ReparentingModel::validateNode(const Node *node) const
@@ -197,13 +219,7 @@ bool ReparentingModel::validateNode(const Node *node) const
             return false;
         }
 
-        bool found = false;
-        for (const Node::Ptr &child : qAsConst(n->parent->children)) {
-            if (child.data() == n) {
-                found = true;
-            }
-        }
-        if (!found) {
+        if (n->row() < 0) {
             qCWarning(KORGANIZER_LOG) << "not linked as child" << depth;
             return false;
         }
@@ -231,17 +247,36 @@ bool ReparentingModel::validateNode(const Node *node) const
     return false;
 }
 
+bool ReparentingModel::isProxyNode(const Node::Ptr &node) const
+{
+    for (const ReparentingModel::Node::Ptr &existing : qAsConst(mProxyNodes)) {
+        if (*existing == *node) {
+            // qCDebug(KORGANIZER_LOG) << "node is already existing";
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReparentingModel::takeNodeToAdd(const Node::Ptr &node)
+{
+    for (int i = 0; i < mNodesToAdd.size(); ++i) {
+        if (*mNodesToAdd.at(i) == *node) {
+            mNodesToAdd.remove(i);
+            return true;
+        }
+    }
+    return false;
+}
+
 void ReparentingModel::addNode(const ReparentingModel::Node::Ptr &node)
 {
     //We have to make this check before issuing the async method,
     //otherwise we run into the problem that while a node is being removed,
     //the async request could be triggered (due to a changed signal),
     //resulting in the node getting readded immediately after it had been removed.
-    for (const ReparentingModel::Node::Ptr &existing : qAsConst(mProxyNodes)) {
-        if (*existing == *node) {
-            // qCDebug(KORGANIZER_LOG) << "node is already existing";
-            return;
-        }
+    if (isProxyNode(node)) {
+        return;
     }
     mNodesToAdd << node;
     qRegisterMetaType<Node::Ptr>("Node::Ptr");
@@ -249,26 +284,40 @@ void ReparentingModel::addNode(const ReparentingModel::Node::Ptr &node)
                               QGenericReturnArgument(), Q_ARG(Node::Ptr, node));
 }
 
-void ReparentingModel::doAddNode(const Node::Ptr &node)
+/**
+ * Same as addNode, but the nodes are inserted into the model with a single row insertion.
+ */
+void ReparentingModel::addNodes(const QVector<Node::Ptr> &nodes)
 {
-    for (const ReparentingModel::Node::Ptr &existing : qAsConst(mProxyNodes)) {
-        if (*existing == *node) {
-            // qCDebug(KORGANIZER_LOG) << "node is already existing";
-            return;
+    QVector<Node::Ptr> newNodes;
+    newNodes.reserve(nodes.size());
+    for (const Node::Ptr &node : nodes) {
+        if (isProxyNode(node)
+            || std::any_of(newNodes.cbegin(), newNodes.cend(), [&node](const Node::Ptr &n) {
+            return *n == *node;
+        })) {
+            continue;
         }
+        mNodesToAdd << node;
+        newNodes << node;
+    }
+    if (newNodes.isEmpty()) {
+        return;
+    }
+    qRegisterMetaType<QVector<Node::Ptr> >("QVector<Node::Ptr>");
+    QMetaObject::invokeMethod(this, "doAddNodes", Qt::QueuedConnection,
+                              QGenericReturnArgument(), Q_ARG(QVector<Node::Ptr>, newNodes));
+}
+
+void ReparentingModel::doAddNode(const Node::Ptr &node)
+{
+    if (isProxyNode(node)) {
+        return;
     }
     //If a datachanged call triggered this through checkSourceIndex, right after a person node has been removed.
     //We'd end-up re-inserting the node that has just been removed. Therefore removeNode can cancel the pending addNode
     //call through mNodesToAdd.
-    bool addNodeAborted = true;
-    for (int i = 0; i < mNodesToAdd.size(); ++i) {
-        if (*mNodesToAdd.at(i) == *node) {
-            mNodesToAdd.remove(i);
-            addNodeAborted = false;
-            break;
-        }
-    }
-    if (addNodeAborted) {
+    if (!takeNodeToAdd(node)) {
         return;
     }
 
@@ -284,6 +333,35 @@ void ReparentingModel::doAddNode(const Node::Ptr &node)
     }
 }
 
+void ReparentingModel::doAddNodes(const QVector<Node::Ptr> &nodes)
+{
+    QVector<Node::Ptr> toInsert;
+    toInsert.reserve(nodes.size());
+    for (const Node::Ptr &node : nodes) {
+        //See doAddNode
+        if (isProxyNode(node) || !takeNodeToAdd(node)) {
+            continue;
+        }
+        if (!isDuplicate(node)) {
+            toInsert << node;
+        }
+        mProxyNodes << node;
+    }
+    if (toInsert.isEmpty()) {
+        return;
+    }
+
+    const int targetRow = mRootNode.children.size();
+    beginInsertRows(QModelIndex(), targetRow, targetRow + toInsert.size() - 1);
+    for (const Node::Ptr &node : qAsConst(toInsert)) {
+        insertProxyNode(node);
+    }
+    endInsertRows();
+    for (const Node::Ptr &node : qAsConst(toInsert)) {
+        reparentSourceNodes(node);
+    }
+}
+
 void ReparentingModel::updateNode(const ReparentingModel::Node::Ptr &node)
 {
     for (const ReparentingModel::Node::Ptr &existing : qAsConst(mProxyNodes)) {
@@ -312,8 +390,9 @@ void ReparentingModel::removeNode(const ReparentingModel::Node &node)
             //TODO: this does not yet take care of un-reparenting reparented nodes.
             const Node &n = *mProxyNodes.at(i);
             Node *parentNode = n.parent;
-            beginRemoveRows(index(parentNode), n.row(), n.row());
-            parentNode->children.remove(n.row()); //deletes node
+            const int targetRow = n.row();
+            beginRemoveRows(index(parentNode), targetRow, targetRow);
+            parentNode->children.remove(targetRow); //deletes node
             mProxyNodes.remove(i);
             endRemoveRows();
             break;
@@ -336,6 +415,8 @@ void ReparentingModel::setNodes(const QList<Node::Ptr> &nodes)
 void ReparentingModel::clear()
 {
     beginResetModel();
+    //Also drop the nodes of pending addNode calls, they belong to what is cleared
+    mNodesToAdd.clear();
     mProxyNodes.clear();
     rebuildAll();
     endResetModel();
@@ -388,22 +469,36 @@ void ReparentingModel::onSourceRowsAboutToBeInserted(const QModelIndex &parent,
     Q_UNUSED(end);
 }
 
-ReparentingModel::Node *ReparentingModel::getReparentNode(const QModelIndex &sourceIndex)
+QVector<ReparentingModel::Node *> ReparentingModel::adoptingNodes() const
 {
+    //The proxy can be ignored if it is a duplicate, so only reparent to proxies that are in the model
+    QVector<Node *> adopters;
+    adopters.reserve(mProxyNodes.size());
     for (const Node::Ptr &proxyNode : qAsConst(mProxyNodes)) {
-        //Reparent source nodes according to the provided rules
-        //The proxy can be ignored if it is a duplicate, so only reparent to proxies that are in the model
-        if (proxyNode->parent && proxyNode->adopts(sourceIndex)) {
-            Q_ASSERT(validateNode(proxyNode.data()));
-            return proxyNode.data();
+        if (proxyNode->parent) {
+            adopters << proxyNode.data();
+        }
+    }
+    return adopters;
+}
+
+ReparentingModel::Node *ReparentingModel::getReparentNode(const QModelIndex &sourceIndex,
+                                                          const QVector<Node *> &adopters) const
+{
+    //Reparent source nodes according to the provided rules
+    for (Node *proxyNode : adopters) {
+        if (proxyNode->adopts(sourceIndex)) {
+            Q_ASSERT(validateNode(proxyNode));
+            return proxyNode;
         }
     }
     return nullptr;
 }
 
-ReparentingModel::Node *ReparentingModel::getParentNode(const QModelIndex &sourceIndex)
+ReparentingModel::Node *ReparentingModel::getParentNode(const QModelIndex &sourceIndex,
+                                                        const QVector<Node *> &adopters)
 {
-    if (Node *node = getReparentNode(sourceIndex)) {
+    if (Node *node = getReparentNode(sourceIndex, adopters)) {
         return node;
     }
     const QModelIndex proxyIndex = mapFromSource(sourceIndex.parent());
@@ -419,7 +514,7 @@ void ReparentingModel::appendSourceNode(Node *parentNode, const QModelIndex &sou
     mNodeManager->checkSourceIndex(sourceIndex);
 
     Node::Ptr node(new Node(*this, parentNode, sourceIndex));
-    parentNode->children.append(node);
+    parentNode->addChild(node);
     Q_ASSERT(validateNode(node.data()));
     rebuildFromSource(node.data(), sourceIndex, skip);
 }
@@ -469,46 +564,78 @@ void ReparentingModel::removeDuplicates(const QModelIndex &sourceIndex)
 void ReparentingModel::onSourceRowsInserted(const QModelIndex &parent, int start, int end)
 {
     // qCDebug(KORGANIZER_LOG) << objectName() << parent << start << end;
+    //Rows following the inserted ones have moved
+    invalidateSourceNodeIndex();
+
+    //Remove any duplicates that we are going to replace
     for (int row = start; row <= end; row++) {
-        QModelIndex sourceIndex = sourceModel()->index(row, 0, parent);
-        Q_ASSERT(sourceIndex.isValid());
-        Node *parentNode = getParentNode(sourceIndex);
-        if (!parentNode) {
-            parentNode = &mRootNode;
-        } else {
-            Q_ASSERT(validateNode(parentNode));
+        removeDuplicates(sourceModel()->index(row, 0, parent));
+    }
+
+    //Looked up once for the whole range, adding source nodes doesn't change the proxies in the model
+    const QVector<Node *> adopters = adoptingNodes();
+
+    int row = start;
+    while (row <= end) {
+        //Collect the contiguous rows that end up below the same parent, they are inserted in one go
+        Node *parentNode = nullptr;
+        QModelIndexList rows;
+        for (; row <= end; row++) {
+            const QModelIndex sourceIndex = sourceModel()->index(row, 0, parent);
+            Q_ASSERT(sourceIndex.isValid());
+            Node *node = getParentNode(sourceIndex, adopters);
+            if (!node) {
+                node = &mRootNode;
+            } else {
+                Q_ASSERT(validateNode(node));
+            }
+            if (parentNode && node != parentNode) {
+                break;
+            }
+            parentNode = node;
+            rows << sourceIndex;
         }
         Q_ASSERT(parentNode);
 
-        //Remove any duplicates that we are going to replace
-        removeDuplicates(sourceIndex);
-
         QModelIndexList reparented;
         //Check for children to reparent
-        {
-            Q_FOREACH (const QModelIndex &descendant, descendants(sourceIndex)) {
-                if (Node *proxyNode = getReparentNode(descendant)) {
-                    qCDebug(KORGANIZER_LOG) << "reparenting " << descendant.data().toString();
-                    int targetRow = proxyNode->children.size();
-                    beginInsertRows(index(proxyNode), targetRow, targetRow);
+        if (!adopters.isEmpty()) {
+            QVector<Node *> proxyNodes;
+            QHash<Node *, QModelIndexList> adopted;
+            for (const QModelIndex &sourceIndex : qAsConst(rows)) {
+                const QModelIndexList descendantList = descendants(sourceIndex);
+                for (const QModelIndex &descendant : descendantList) {
+                    if (Node *proxyNode = getReparentNode(descendant, adopters)) {
+                        qCDebug(KORGANIZER_LOG) << "reparenting " << descendant.data().toString();
+                        if (!adopted.contains(proxyNode)) {
+                            proxyNodes << proxyNode;
+                        }
+                        adopted[proxyNode] << descendant;
+                        reparented << descendant;
+                    }
+                }
+            }
+            for (Node *proxyNode : qAsConst(proxyNodes)) {
+                const QModelIndexList &list = adopted[proxyNode];
+                const int targetRow = proxyNode->children.size();
+                beginInsertRows(index(proxyNode), targetRow, targetRow + list.size() - 1);
+                for (const QModelIndex &descendant : list) {
                     appendSourceNode(proxyNode, descendant);
-                    reparented << descendant;
-                    endInsertRows();
                 }
+                endInsertRows();
             }
         }
 
-        if (parentNode->isSourceNode()) {
-            int targetRow = parentNode->children.size();
-            beginInsertRows(mapFromSource(parent), targetRow, targetRow);
+        //Reparented rows keep their whole subtree
+        if (!parentNode->isSourceNode()) {
+            reparented.clear();
+        }
+        const int targetRow = parentNode->children.size();
+        beginInsertRows(index(parentNode), targetRow, targetRow + rows.size() - 1);
+        for (const QModelIndex &sourceIndex : qAsConst(rows)) {
             appendSourceNode(parentNode, sourceIndex, reparented);
-            endInsertRows();
-        } else { //Reparented
-            int targetRow = parentNode->children.size();
-            beginInsertRows(index(parentNode), targetRow, targetRow);
-            appendSourceNode(parentNode, sourceIndex);
-            endInsertRows();
         }
+        endInsertRows();
     }
 }
 
@@ -541,6 +668,7 @@ void ReparentingModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, i
 void ReparentingModel::onSourceRowsRemoved(const QModelIndex & /* parent */, int /* start */,
                                            int /* end */)
 {
+    invalidateSourceNodeIndex();
 }
 
 void ReparentingModel::onSourceRowsAboutToBeMoved(const QModelIndex & /* sourceParent */,
@@ -557,6 +685,7 @@ void ReparentingModel::onSourceRowsMoved(const QModelIndex & /* sourceParent */,
                                          int /* sourceStart */, int /* sourceEnd */,
                                          const QModelIndex & /* destParent */, int /* dest */)
 {
+    invalidateSourceNodeIndex();
     qCWarning(KORGANIZER_LOG) << "not implemented";
     //TODO
     endResetModel();
@@ -580,6 +709,8 @@ void ReparentingModel::onSourceLayoutAboutToBeChanged()
 
 void ReparentingModel::onSourceLayoutChanged()
 {
+    invalidateSourceNodeIndex();
+
     //By ignoring this we miss structural changes in the sourcemodel, which is mostly ok.
     //Before we can re-enable this we need to properly deal with skipped duplicates, because
     //a layout change MUST NOT add/remove new nodes (only shuffling allowed)
@@ -665,15 +796,27 @@ QModelIndex ReparentingModel::mapToSource(const QModelIndex &idx) const
     return node->sourceIndex;
 }
 
+void ReparentingModel::invalidateSourceNodeIndex()
+{
+    mSourceNodeIndexDirty = true;
+    mSourceNodeByIndex.clear();
+}
+
 ReparentingModel::Node *ReparentingModel::getSourceNode(const QModelIndex &sourceIndex) const
 {
-    for (Node *n : qAsConst(mSourceNodes)) {
-        if (n->sourceIndex == sourceIndex) {
-            return n;
+    if (mSourceNodeIndexDirty) {
+        mSourceNodeByIndex.reserve(mSourceNodes.size());
+        for (Node *n : qAsConst(mSourceNodes)) {
+            if (n->sourceIndex.isValid()) {
+                mSourceNodeByIndex.insert(n->sourceIndex, n);
+            }
         }
+        mSourceNodeIndexDirty = false;
     }
-    // qCDebug(KORGANIZER_LOG) << objectName() <<  "no node found for " << sourceIndex;
-    return nullptr;
+    Node *node = mSourceNodeByIndex.value(sourceIndex);
+    // if (!node) qCDebug(KORGANIZER_LOG) << objectName() <<  "no node found for " << sourceIndex;
+    Q_ASSERT(!node || node->sourceIndex == sourceIndex);
+    return node;
 }
 
 QModelIndex ReparentingModel::mapFromSource(const QModelIndex &sourceIndex) const
@@ -760,7 +903,10 @@ void ReparentingModel::rebuildAll()
     }
     Q_ASSERT(mSourceNodes.isEmpty());
     mSourceNodes.clear();
+    invalidateSourceNodeIndex();
     rebuildFromSource(&mRootNode, QModelIndex());
+    QVector<Node *> adopters;
+    adopters.reserve(mProxyNodes.size());
     for (const Node::Ptr &proxyNode : qAsConst(mProxyNodes)) {
         // qCDebug(KORGANIZER_LOG) << "checking " << proxyNode->data(Qt::DisplayRole).toString();
         //Avoid inserting a node that is already part of the source model
@@ -768,7 +914,17 @@ void ReparentingModel::rebuildAll()
             continue;
         }
         insertProxyNode(proxyNode);
-        reparentSourceNodes(proxyNode);
+        adopters << proxyNode.data();
+    }
+    if (adopters.isEmpty()) {
+        return;
+    }
+    //We're within a reset, so the source nodes are reparented in a single pass without emitting row signals
+    for (Node *n : qAsConst(mSourceNodes)) {
+        if (Node *proxyNode = getReparentNode(n->sourceIndex, adopters)) {
+            proxyNode->reparent(n);
+            Q_ASSERT(validateNode(n));
+        }
     }
 }
 
@@ -819,14 +975,7 @@ int ReparentingModel::row(ReparentingModel::Node *node) const
         return -1;
     }
     Q_ASSERT(validateNode(node));
-    int row = 0;
-    for (const Node::Ptr &c : qAsConst(node->parent->children)) {
-        if (c.data() == node) {
-            return row;
-        }
-        row++;
-    }
-    return -1;
+    return node->row();
 }
 
 QModelIndex ReparentingModel::index(Node *node) const
@@ -24,6 +24,7 @@
 #define KORG_REPARENTINGMODEL_H
 
 #include <QAbstractProxyModel>
+#include <QHash>
 #include <QSharedPointer>
 #include <QVector>
 
@@ -57,6 +58,7 @@ public:
         void reparent(Node *node);
         void addChild(const Node::Ptr &node);
         int row() const;
+        void renumberChildren() const;
         void clearHierarchy();
 
         QPersistentModelIndex sourceIndex;
@@ -64,6 +66,8 @@ public:
         Node *parent = nullptr;
         ReparentingModel &personModel;
         bool mIsSourceNode;
+        //Position in parent->children, renumbered lazily once it no longer matches
+        mutable int mRow = -1;
     };
 
     struct NodeManager {
@@ -104,6 +108,7 @@ public:
 
     void setNodeManager(const NodeManager::Ptr &nodeManager);
     void addNode(const Node::Ptr &node);
+    void addNodes(const QVector<Node::Ptr> &nodes);
     void updateNode(const Node::Ptr &node);
     void removeNode(const Node &node);
     void setNodes(const QList<Node::Ptr> &nodes);
@@ -137,18 +142,22 @@ private Q_SLOTS:
     void onSourceModelAboutToBeReset();
     void onSourceModelReset();
     void doAddNode(const Node::Ptr &node);
+    void doAddNodes(const QVector<Node::Ptr> &nodes);
 
 private:
     void rebuildFromSource(Node *parentNode, const QModelIndex &idx,
                            const QModelIndexList &skip = QModelIndexList());
     bool isDuplicate(const Node::Ptr &proxyNode) const;
+    bool isProxyNode(const Node::Ptr &node) const;
+    bool takeNodeToAdd(const Node::Ptr &node);
     void insertProxyNode(const Node::Ptr &proxyNode);
     void reparentSourceNodes(const Node::Ptr &proxyNode);
     void rebuildAll();
     QModelIndex index(Node *node) const;
     int row(Node *node) const;
-    Node *getReparentNode(const QModelIndex &sourceIndex);
-    Node *getParentNode(const QModelIndex &sourceIndex);
+    QVector<Node *> adoptingNodes() const;
+    Node *getReparentNode(const QModelIndex &sourceIndex, const QVector<Node *> &adopters) const;
+    Node *getParentNode(const QModelIndex &sourceIndex, const QVector<Node *> &adopters);
     bool validateNode(const Node *node) const;
     Node *extractNode(const QModelIndex &index) const;
     void appendSourceNode(Node *parentNode, const QModelIndex &sourceIndex,
@@ -156,9 +165,14 @@ private:
     QModelIndexList descendants(const QModelIndex &sourceIndex);
     void removeDuplicates(const QModelIndex &sourceIndex);
     Node *getSourceNode(const QModelIndex &sourceIndex) const;
+    void invalidateSourceNodeIndex();
 
     Node mRootNode;
     QList<Node *> mSourceNodes;
+    //Source index to source node lookup for mapFromSource. Source rows shift on every
+    //structural change of the source model, so the hash is rebuilt lazily after those.
+    mutable QHash<QModelIndex, Node *> mSourceNodeByIndex;
+    mutable bool mSourceNodeIndexDirty = false;
     QVector<Node::Ptr> mProxyNodes;
     QVector<Node::Ptr> mNodesToAdd;
     NodeManager::Ptr mNodeManager;
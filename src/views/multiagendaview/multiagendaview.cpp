@@ -192,6 +192,13 @@ Akonadi::Collection::Id MultiAgendaView::collectionId() const
 void MultiAgendaView::changeIncidenceDisplay(const Akonadi::Item &,
                                              Akonadi::IncidenceChanger::ChangeType)
 {
+    // Nothing to do, the column showing the item's collection already got the
+    // change from its calendar. See observesCalendar().
+}
+
+bool MultiAgendaView::observesCalendar() const
+{
+    return true;
 }
 
 int MultiAgendaView::maxDatesHint() const
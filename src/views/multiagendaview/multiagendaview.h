@@ -60,6 +60,12 @@ public:
 
     void setChanges(EventViews::EventView::Changes changes) override;
 
+    /**
+     * reimplemented from KOrg::BaseView, every column observes the calendar
+     * of its collections and updates only itself.
+     */
+    bool observesCalendar() const override;
+
     KCheckableProxyModel *takeCustomCollectionSelectionProxyModel();
     void setCustomCollectionSelectionProxyModel(KCheckableProxyModel *model);
 
@@ -23,15 +23,28 @@
 */
 
 #include "kowhatsnextview.h"
+
+#include <CalendarSupport/Utils>
+
+#include <QTimer>
 #include <QVBoxLayout>
 
+//Changes arriving within this time are shown together
+static const int ChangeDelay = 100;
+
 KOWhatsNextView::KOWhatsNextView(QWidget *parent)
     : KOrg::BaseView(parent)
+    , mPendingChangeType(Akonadi::IncidenceChanger::ChangeTypeModify)
 {
     mView = new EventViews::WhatsNextView(this);
     QVBoxLayout *topLayout = new QVBoxLayout(this);
     topLayout->addWidget(mView);
 
+    mChangeTimer = new QTimer(this);
+    mChangeTimer->setSingleShot(true);
+    mChangeTimer->setInterval(ChangeDelay);
+    connect(mChangeTimer, &QTimer::timeout, this, &KOWhatsNextView::applyPendingChanges);
+
     connect(mView, &EventViews::EventView::incidenceSelected,
             this, &KOrg::BaseView::incidenceSelected);
 
@@ -101,6 +114,10 @@ int KOWhatsNextView::currentDateCount() const
 
 void KOWhatsNextView::updateView()
 {
+    // Shows all pending changes as well
+    mChangeTimer->stop();
+    mPendingChangeCount = 0;
+    mPendingItem = Akonadi::Item();
     mView->updateView();
 }
 
@@ -114,10 +131,30 @@ void KOWhatsNextView::showIncidences(const Akonadi::Item::List &incidenceList, c
     mView->showIncidences(incidenceList, date);
 }
 
-void KOWhatsNextView::changeIncidenceDisplay(const Akonadi::Item &,
-                                             Akonadi::IncidenceChanger::ChangeType)
+void KOWhatsNextView::changeIncidenceDisplay(const Akonadi::Item &item,
+                                             Akonadi::IncidenceChanger::ChangeType changeType)
+{
+    // Journals are not listed on the page
+    const KCalCore::Incidence::Ptr incidence = CalendarSupport::incidence(item);
+    if (incidence && incidence->type() == KCalCore::Incidence::TypeJournal) {
+        return;
+    }
+
+    mPendingItem = item;
+    mPendingChangeType = changeType;
+    ++mPendingChangeCount;
+    mChangeTimer->start();
+}
+
+void KOWhatsNextView::applyPendingChanges()
 {
-    updateView();
+    if (mPendingChangeCount == 1) {
+        mView->changeIncidenceDisplay(mPendingItem, mPendingChangeType);
+        mPendingChangeCount = 0;
+        mPendingItem = Akonadi::Item();
+    } else if (mPendingChangeCount > 1) {
+        updateView();
+    }
 }
 
 CalendarSupport::CalPrinterBase::PrintType KOWhatsNextView::printType() const
@@ -27,6 +27,8 @@
 #include "baseview.h"
 #include <EventViews/WhatsNextView>
 
+class QTimer;
+
 /**
   This class provides a view of the next events and todos
 */
@@ -65,7 +67,14 @@ public Q_SLOTS:
                                 Akonadi::IncidenceChanger::ChangeType) override;
 
 private:
+    void applyPendingChanges();
+
     EventViews::WhatsNextView *mView = nullptr;
+    //Collects the changes of a burst, the page is generated once for all of them
+    QTimer *mChangeTimer = nullptr;
+    Akonadi::Item mPendingItem;
+    Akonadi::IncidenceChanger::ChangeType mPendingChangeType;
+    int mPendingChangeCount = 0;
 };
 
 #endif
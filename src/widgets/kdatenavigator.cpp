@@ -117,6 +117,11 @@ void KDateNavigator::setCalendar(const Akonadi::ETMCalendar::Ptr &calendar)
     mDayMatrix->setCalendar(calendar);
 }
 
+void KDateNavigator::setDayInfoCache(DayInfoCache *cache)
+{
+    mDayMatrix->setDayInfoCache(cache);
+}
+
 void KDateNavigator::setBaseDate(const QDate &date)
 {
     if (date != mBaseDate) {
@@ -31,6 +31,7 @@
 #include <KCalCore/IncidenceBase> //for DateList typedef
 #include <Akonadi/Calendar/ETMCalendar>
 
+class DayInfoCache;
 class KODayMatrix;
 class NavigatorBar;
 
@@ -52,6 +53,11 @@ public:
     */
     void setCalendar(const Akonadi::ETMCalendar::Ptr &);
 
+    /**
+      Share @p cache with the other navigators. It is used by KODayMatrix.
+    */
+    void setDayInfoCache(DayInfoCache *cache);
+
     void setBaseDate(const QDate &);
 
     KCalCore::DateList selectedDates() const